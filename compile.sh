@@ -1,2 +1,2 @@
 #!/bin/bash
-g++ -std=c++11 -o program ./src/*.cpp `sdl2-config --cflags --libs` -lSDL2_image -lSDL2_ttf
+g++ -std=c++11 -o program ./src/*.cpp `sdl2-config --cflags --libs` -lSDL2_image -lSDL2_ttf -pthread
@@ -0,0 +1,40 @@
+#ifndef CHUNK_H
+#define CHUNK_H
+
+#include "Tile.h"
+#include <SDL.h>
+#include <vector>
+
+// log2 of the chunk width in tiles; the build sets it through the CHUNK_SIZE
+// CMake option (16, 32 or 64)
+#ifndef CHUNK_SIZE_LOG2
+#define CHUNK_SIZE_LOG2 5
+#endif
+
+// A square block of tiles stored as one contiguous, row-major array of
+// 1-byte tile IDs. Screen and atlas rects are derived when rendering.
+// The dimension is fixed at compile time so addressing is shifts and masks.
+class Chunk {
+public:
+    static const int SHIFT = CHUNK_SIZE_LOG2;
+    static const int SIZE = 1 << SHIFT; // Width and height in tiles
+    static const int MASK = SIZE - 1;
+    static const int AREA = SIZE * SIZE;
+
+    TileType getTile(int x, int y) const { return static_cast<TileType>(tiles[(y << SHIFT) | x]); }
+    void setTile(int x, int y, TileType type) { tiles[(y << SHIFT) | x] = static_cast<Uint8>(type); }
+
+    // World tile coordinate to chunk coordinate and position within the
+    // chunk; arithmetic shifts floor, so negative coordinates work too
+    static int chunkOf(int tile) { return tile >> SHIFT; }
+    static int offsetIn(int tile) { return tile & MASK; }
+    // The same rounding for any positive divisor, for grids that are not
+    // chunk-sized (biome lattices, tiles under a pixel position)
+    static int floorDiv(int a, int b) { return a >= 0 ? a / b : -((-a + b - 1) / b); }
+
+    std::vector<Uint8> tiles; // AREA entries, or empty while the chunk has no buffer
+};
+
+static_assert(Chunk::SHIFT >= 2 && Chunk::SHIFT <= 8, "CHUNK_SIZE_LOG2 must be between 2 and 8");
+
+#endif
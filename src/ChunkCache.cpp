@@ -0,0 +1,155 @@
+#include "ChunkCache.h"
+#include <algorithm>
+#include <utility>
+
+ChunkCache::ChunkCache(size_t budgetBytes)
+    : budgetBytes(0), tableMask(0), head(-1), tail(-1), used(0), hits(0), misses(0) {
+    setBudget(budgetBytes);
+}
+
+size_t ChunkCache::getEntryBytes() const {
+    return Chunk::AREA + sizeof(Entry) + 2 * sizeof(int);
+}
+
+void ChunkCache::setBudget(size_t newBudget) {
+    budgetBytes = newBudget;
+    int newCapacity = static_cast<int>(budgetBytes / getEntryBytes());
+
+    entries.clear();
+    entries.resize(newCapacity);
+    freeEntries.clear();
+    for (int i = newCapacity - 1; i >= 0; --i) {
+        entries[i].chunk.tiles.assign(Chunk::AREA, GRASS);
+        freeEntries.push_back(i);
+    }
+
+    // Keep the index at most half full so probe chains stay short
+    int tableSize = 1;
+    while (tableSize < newCapacity * 2) {
+        tableSize <<= 1;
+    }
+    table.assign(tableSize, -1);
+    tableMask = tableSize - 1;
+    head = tail = -1;
+    used = 0;
+}
+
+void ChunkCache::clear() {
+    for (int i = head; i != -1; i = entries[i].next) {
+        freeEntries.push_back(i);
+    }
+    std::fill(table.begin(), table.end(), -1);
+    head = tail = -1;
+    used = 0;
+}
+
+int ChunkCache::homeOf(int chunkX, int chunkY) const {
+    unsigned int hash = static_cast<unsigned int>(chunkX) * 73856093u ^ static_cast<unsigned int>(chunkY) * 19349663u;
+    return static_cast<int>(hash) & tableMask;
+}
+
+int ChunkCache::findEntry(int chunkX, int chunkY) const {
+    if (capacity() == 0) return -1;
+    for (int i = homeOf(chunkX, chunkY); table[i] != -1; i = (i + 1) & tableMask) {
+        const Entry& entry = entries[table[i]];
+        if (entry.chunkX == chunkX && entry.chunkY == chunkY) {
+            return table[i];
+        }
+    }
+    return -1;
+}
+
+void ChunkCache::insertKey(int entry) {
+    int i = homeOf(entries[entry].chunkX, entries[entry].chunkY);
+    while (table[i] != -1) {
+        i = (i + 1) & tableMask;
+    }
+    table[i] = entry;
+}
+
+void ChunkCache::eraseKey(int entry) {
+    int i = homeOf(entries[entry].chunkX, entries[entry].chunkY);
+    while (table[i] != entry) {
+        i = (i + 1) & tableMask;
+    }
+
+    // Backward-shift deletion keeps probe chains intact without tombstones
+    table[i] = -1;
+    for (int j = (i + 1) & tableMask; table[j] != -1; j = (j + 1) & tableMask) {
+        int home = homeOf(entries[table[j]].chunkX, entries[table[j]].chunkY);
+        bool movable = (j > i) ? (home <= i || home > j) : (home <= i && home > j);
+        if (movable) {
+            table[i] = table[j];
+            table[j] = -1;
+            i = j;
+        }
+    }
+}
+
+void ChunkCache::unlink(int entry) {
+    Entry& e = entries[entry];
+    if (e.prev != -1) entries[e.prev].next = e.next; else head = e.next;
+    if (e.next != -1) entries[e.next].prev = e.prev; else tail = e.prev;
+}
+
+void ChunkCache::pushFront(int entry) {
+    Entry& e = entries[entry];
+    e.prev = -1;
+    e.next = head;
+    if (head != -1) entries[head].prev = entry;
+    head = entry;
+    if (tail == -1) tail = entry;
+}
+
+bool ChunkCache::take(int chunkX, int chunkY, Chunk& chunk) {
+    int entry = findEntry(chunkX, chunkY);
+    if (entry == -1) {
+        ++misses;
+        return false;
+    }
+
+    ++hits;
+    std::swap(entries[entry].chunk, chunk);
+    eraseKey(entry);
+    unlink(entry);
+    freeEntries.push_back(entry);
+    --used;
+    return true;
+}
+
+void ChunkCache::put(int chunkX, int chunkY, Chunk& chunk) {
+    if (capacity() == 0) return;
+
+    int entry = findEntry(chunkX, chunkY);
+    if (entry != -1) {
+        // Already cached (e.g. evicted twice without being taken); refresh it
+        eraseKey(entry);
+        unlink(entry);
+    } else if (!freeEntries.empty()) {
+        entry = freeEntries.back();
+        freeEntries.pop_back();
+        ++used;
+    } else {
+        // Full: recycle the least recently used entry
+        entry = tail;
+        eraseKey(entry);
+        unlink(entry);
+    }
+
+    Entry& e = entries[entry];
+    e.chunkX = chunkX;
+    e.chunkY = chunkY;
+    std::swap(e.chunk, chunk);
+    insertKey(entry);
+    pushFront(entry);
+}
+
+ChunkCache::Stats ChunkCache::getStats() const {
+    Stats stats;
+    stats.hits = hits;
+    stats.misses = misses;
+    stats.entries = used;
+    stats.bytes = used * static_cast<size_t>(Chunk::AREA);
+    stats.budgetBytes = budgetBytes;
+    return stats;
+}
@@ -0,0 +1,64 @@
+#ifndef CHUNKCACHE_H
+#define CHUNKCACHE_H
+
+#include "Chunk.h"
+#include <vector>
+#include <cstddef>
+
+// Second tier behind the active chunk ring: keeps recently evicted chunks in
+// LRU order within a byte budget, so walking back over old ground reuses them
+// instead of regenerating. Every entry owns a full-size tile buffer from the
+// moment the budget is set, and chunks move in and out by trading buffers one
+// for one, so steady use never allocates and never runs a buffer dry.
+class ChunkCache {
+public:
+    struct Stats {
+        long long hits;
+        long long misses;
+        int entries;
+        size_t bytes;       // Bytes held by cached chunks
+        size_t budgetBytes;
+    };
+
+    explicit ChunkCache(size_t budgetBytes);
+    void setBudget(size_t budgetBytes);
+
+    // On a hit, swaps the cached chunk into `chunk` and forgets it. `chunk`
+    // must hold a full-size buffer, which the entry keeps in exchange
+    bool take(int chunkX, int chunkY, Chunk& chunk);
+    // Swaps `chunk` into the cache (evicting the least recently used entry if
+    // full); `chunk` comes back holding the entry's full-size spare buffer
+    void put(int chunkX, int chunkY, Chunk& chunk);
+    void clear();
+
+    Stats getStats() const;
+    size_t getEntryBytes() const;
+
+private:
+    struct Entry {
+        int chunkX;
+        int chunkY;
+        Chunk chunk;
+        int prev; // Towards the most recently used end
+        int next;
+    };
+
+    int capacity() const { return static_cast<int>(entries.size()); }
+    int homeOf(int chunkX, int chunkY) const;
+    int findEntry(int chunkX, int chunkY) const;
+    void insertKey(int entry);
+    void eraseKey(int entry);
+    void unlink(int entry);
+    void pushFront(int entry);
+
+    size_t budgetBytes;
+    std::vector<Entry> entries;
+    std::vector<int> freeEntries;
+    std::vector<int> table; // Open-addressed index into entries, -1 when empty
+    int tableMask;
+    int head, tail; // Most and least recently used entries
+    int used;
+    long long hits, misses;
+};
+
+#endif
@@ -0,0 +1,194 @@
+#include "ChunkGenerator.h"
+#include "Profiler.h"
+#include <cmath>
+#include <cstring>
+#include <utility>
+
+const ChunkGenerator::Stage ChunkGenerator::stages[] = {
+    {"terrain", 0, &ChunkGenerator::runTerrain},
+    {"shoreline", 1, &ChunkGenerator::runShoreline},
+    {"decoration", 1, &ChunkGenerator::runDecoration},
+};
+const int ChunkGenerator::stageCount = sizeof(stages) / sizeof(stages[0]);
+
+ChunkGenerator::ChunkGenerator(unsigned int seed, int biomeStep) : seed(seed), biomeStep(biomeStep < 1 ? 1 : biomeStep),
+    padding(0),
+    grasslandThreshold(-0.2), // Adjust this for more Grassland
+    snowThreshold(-0.6) {     // Adjust this for more Snow
+    // Noise setup: Perlin fields matching FastNoiseLite's defaults (frequency 0.01)
+    noise.seed = seed;
+    noise.frequency = 0.01f;
+    biomeNoise.seed = seed + 1;
+    biomeNoise.frequency = 0.01f;
+    riverNoise.seed = seed + 2;
+    riverNoise.frequency = 0.05f;
+    coarseBiomeNoise.seed = biomeNoise.seed;
+    coarseBiomeNoise.frequency = biomeNoise.frequency * this->biomeStep;
+
+    for (int i = 0; i < stageCount; ++i) {
+        padding += stages[i].apron;
+    }
+    side = Chunk::SIZE + 2 * padding;
+
+    noiseValues.resize(side * side);
+    biomeValues.resize(side * side);
+    riverValues.resize(side * side);
+    lerpIndex.resize(side);
+    lerpWeight.resize(side);
+    work.resize(side * side);
+    next.resize(side * side);
+}
+
+TileType ChunkGenerator::generateGrasslandTile(float noiseValue, float riverNoiseValue, float biomeValue, int x, int y) {
+    // Example implementation for grassland
+    // Adjust thresholds and logic as per your game's design
+
+    const float riverThreshold = 0.2; // Threshold for rivers
+    const float riverEdgeThreshold = 0.25; // Threshold for river edges
+
+    bool isRiver = riverNoiseValue < riverThreshold;
+    bool isRiverEdge = riverNoiseValue >= riverThreshold && riverNoiseValue < riverEdgeThreshold;
+
+    if (isRiver) {
+        return WATER; // River tile
+    } else if (isRiverEdge) {
+        return SAND; // River edge, possibly a beach
+    } else {
+        return GRASS; // Grassland
+    }
+}
+
+TileType ChunkGenerator::generateSnowTile(float noiseValue, float biomeValue, int x, int y) {
+    // Simple implementation for snow/tundra biome
+    // You can add more complex logic for features like frozen lakes
+
+    return SNOW; // Snow tile
+}
+
+void ChunkGenerator::generate(int chunkX, int chunkY, Chunk& chunk) {
+    PROFILE_ZONE(ZONE_GENERATE_CHUNK);
+    // Sample every noise field for the chunk and its apron. The per-tile
+    // fields share one fused pass; a coarse biome field is interpolated from
+    // its own lattice instead
+    int originX = chunkX * Chunk::SIZE - padding;
+    int originY = chunkY * Chunk::SIZE - padding;
+    NoiseChannel channels[3] = {noise, riverNoise, biomeNoise};
+    float* outs[3] = {noiseValues.data(), riverValues.data(), biomeValues.data()};
+    NoiseBatch::perlinGrids(channels, biomeStep == 1 ? 3 : 2, originX, originY, side, side, outs);
+    if (biomeStep > 1) {
+        sampleBiome(originX, originY);
+    }
+
+    // Each stage consumes its apron, so it produces a smaller area than the
+    // stage before it; the last one produces exactly the chunk
+    int margin = padding;
+    for (int i = 0; i < stageCount; ++i) {
+        margin -= stages[i].apron;
+        (this->*stages[i].run)(margin);
+        work.swap(next);
+    }
+
+    chunk.tiles.resize(Chunk::AREA);
+    for (int y = 0; y < Chunk::SIZE; ++y) {
+        memcpy(&chunk.tiles[y << Chunk::SHIFT], &work[index(0, y)], Chunk::SIZE);
+    }
+}
+
+void ChunkGenerator::sampleBiome(int originX, int originY) {
+    // Lattice points bracketing the padded grid, evaluated in one batch; cells
+    // round down, so the lattice stays world-aligned across chunks
+    int firstX = Chunk::floorDiv(originX, biomeStep);
+    int firstY = Chunk::floorDiv(originY, biomeStep);
+    int latticeWidth = Chunk::floorDiv(originX + side - 1, biomeStep) - firstX + 2;
+    int latticeHeight = Chunk::floorDiv(originY + side - 1, biomeStep) - firstY + 2;
+    coarseBiomeValues.resize(latticeWidth * latticeHeight);
+    NoiseBatch::perlinGrid(coarseBiomeNoise, firstX, firstY, latticeWidth, latticeHeight, coarseBiomeValues.data());
+
+    // Column cells and weights are the same for every row
+    float invStep = 1.0f / biomeStep;
+    for (int i = 0; i < side; ++i) {
+        int cell = Chunk::floorDiv(originX + i, biomeStep);
+        lerpIndex[i] = cell - firstX;
+        lerpWeight[i] = (originX + i - cell * biomeStep) * invStep;
+    }
+
+    for (int y = 0; y < side; ++y) {
+        int cellY = Chunk::floorDiv(originY + y, biomeStep);
+        float weightY = (originY + y - cellY * biomeStep) * invStep;
+        const float* top = &coarseBiomeValues[(cellY - firstY) * latticeWidth];
+        const float* bottom = top + latticeWidth;
+        float* out = &biomeValues[y * side];
+        for (int x = 0; x < side; ++x) {
+            int cx = lerpIndex[x];
+            float weightX = lerpWeight[x];
+            float upper = top[cx] + (top[cx + 1] - top[cx]) * weightX;
+            float lower = bottom[cx] + (bottom[cx + 1] - bottom[cx]) * weightX;
+            out[x] = upper + (lower - upper) * weightY;
+        }
+    }
+}
+
+// Basic terrain types (grass and snow) straight from the noise
+void ChunkGenerator::runTerrain(int margin) {
+    for (int y = -margin; y < Chunk::SIZE + margin; ++y) {
+        for (int x = -margin, i = index(-margin, y); x < Chunk::SIZE + margin; ++x, ++i) {
+            float biomeValue = biomeValues[i];
+            float noiseValue = noiseValues[i];
+            float riverNoiseValue = std::abs(riverValues[i]);
+
+            TileType type;
+            if (biomeValue > grasslandThreshold) {
+                type = generateGrasslandTile(noiseValue, riverNoiseValue, biomeValue, x, y);
+            } else {
+                type = generateSnowTile(noiseValue, biomeValue, x, y);
+            }
+
+            next[i] = static_cast<Uint8>(type);
+        }
+    }
+}
+
+// Beaches (sand) on grass next to water, including water in the next chunk
+void ChunkGenerator::runShoreline(int margin) {
+    for (int y = -margin; y < Chunk::SIZE + margin; ++y) {
+        for (int x = -margin, i = index(-margin, y); x < Chunk::SIZE + margin; ++x, ++i) {
+            next[i] = (work[i] == GRASS && checkAdjacentToWater(x, y)) ? SAND : work[i];
+        }
+    }
+}
+
+// Tidy-up: a single grass tile stranded in the middle of a beach becomes sand
+void ChunkGenerator::runDecoration(int margin) {
+    for (int y = -margin; y < Chunk::SIZE + margin; ++y) {
+        for (int x = -margin, i = index(-margin, y); x < Chunk::SIZE + margin; ++x, ++i) {
+            next[i] = (work[i] == GRASS && checkSurroundedBy(x, y, SAND)) ? SAND : work[i];
+        }
+    }
+}
+
+bool ChunkGenerator::checkAdjacentToWater(int x, int y) const {
+    for (int dy = -1; dy <= 1; ++dy) {
+        for (int dx = -1; dx <= 1; ++dx) {
+            if (dx == 0 && dy == 0) continue; // Skip the current tile
+
+            // The apron guarantees the neighbour exists, even across chunk borders
+            if (work[index(x + dx, y + dy)] == WATER) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+bool ChunkGenerator::checkSurroundedBy(int x, int y, TileType type) const {
+    for (int dy = -1; dy <= 1; ++dy) {
+        for (int dx = -1; dx <= 1; ++dx) {
+            if (dx == 0 && dy == 0) continue; // Skip the current tile
+
+            if (work[index(x + dx, y + dy)] != type) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
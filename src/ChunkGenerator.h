@@ -0,0 +1,76 @@
+#ifndef CHUNKGENERATOR_H
+#define CHUNKGENERATOR_H
+
+#include "Tile.h"
+#include "Chunk.h"
+#include "NoiseBatch.h"
+#include <vector>
+
+// Turns chunk coordinates into tiles. Holds its own noise settings and scratch
+// buffers, so each generation thread owns a separate instance.
+//
+// Generation runs as a pipeline of stages (terrain, shoreline, decoration).
+// Each stage reads the previous stage's output and declares an apron: how many
+// tiles of that output it needs beyond the chunk edge. Terrain is a pure
+// function of the noise, so instead of waiting for neighbouring chunks the
+// generator samples the noise over the chunk plus the combined apron once, and
+// every later stage sees correct data across chunk borders.
+class ChunkGenerator {
+public:
+    // Bump whenever generate() produces different tiles for the same seed, so
+    // chunks saved by an older build are regenerated instead of reused
+    static const Uint32 VERSION = 3;
+
+    // The biome field varies over hundreds of tiles, so by default it is
+    // sampled every BIOME_STEP tiles on a world-aligned lattice and bilinearly
+    // interpolated in between. A step of 1 samples every tile exactly. Saved
+    // chunks assume the default step
+    static const int BIOME_STEP = 4;
+
+    explicit ChunkGenerator(unsigned int seed, int biomeStep = BIOME_STEP);
+    void generate(int chunkX, int chunkY, Chunk& chunk);
+    unsigned int getSeed() const { return seed; }
+    int getBiomeStep() const { return biomeStep; }
+
+private:
+    struct Stage {
+        const char* name;
+        int apron; // Tiles of the previous stage's output needed on every side
+        void (ChunkGenerator::*run)(int margin);
+    };
+    static const Stage stages[];
+    static const int stageCount;
+
+    // Stages write `next` for every tile within `margin` tiles of the chunk,
+    // reading `work`
+    void runTerrain(int margin);
+    void runShoreline(int margin);
+    void runDecoration(int margin);
+
+    TileType generateGrasslandTile(float noiseValue, float riverNoiseValue, float biomeValue, int x, int y);
+    TileType generateSnowTile(float noiseValue, float biomeValue, int x, int y);
+
+    void sampleBiome(int originX, int originY);
+    bool checkAdjacentToWater(int x, int y) const;
+    bool checkSurroundedBy(int x, int y, TileType type) const;
+
+    // Index into the padded working grids of a chunk-local coordinate, which
+    // may be up to `padding` tiles outside the chunk
+    int index(int x, int y) const { return (y + padding) * side + (x + padding); }
+
+    unsigned int seed;
+    int biomeStep;
+    int padding; // Sum of all stage aprons
+    int side;    // Chunk::SIZE + 2 * padding
+    float grasslandThreshold;
+    float snowThreshold;
+    NoiseChannel noise, biomeNoise, riverNoise;
+    NoiseChannel coarseBiomeNoise; // biomeNoise scaled so lattice point i lands on tile i * biomeStep
+    std::vector<float> noiseValues, biomeValues, riverValues; // Padded noise grids
+    std::vector<float> coarseBiomeValues; // Biome lattice covering the padded grid
+    std::vector<int> lerpIndex;           // Lattice column of each padded column
+    std::vector<float> lerpWeight;        // Position of each padded column within its lattice cell (0..1)
+    std::vector<Uint8> work, next; // Padded tile grids, swapped after every stage
+};
+
+#endif
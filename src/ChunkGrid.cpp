@@ -0,0 +1,139 @@
+#include "ChunkGrid.h"
+#include <algorithm>
+#include <utility>
+
+namespace {
+// Ring dimensions must be powers of two so that `& mask` is a true modulo,
+// including for negative chunk coordinates
+int nextPowerOfTwo(int value) {
+    int result = 1;
+    while (result < value) {
+        result <<= 1;
+    }
+    return result;
+}
+}
+
+ChunkGrid::ChunkGrid(int width, int height)
+    : width(nextPowerOfTwo(width)), height(nextPowerOfTwo(height)),
+      maskX(this->width - 1), maskY(this->height - 1),
+      slots(this->width * this->height) {
+    clear();
+    linkNeighbors();
+}
+
+ChunkGrid::ChunkGrid(const ChunkGrid& other)
+    : width(other.width), height(other.height), maskX(other.maskX), maskY(other.maskY),
+      slots(other.slots) {
+    linkNeighbors();
+}
+
+ChunkGrid& ChunkGrid::operator=(const ChunkGrid& other) {
+    if (this != &other) {
+        width = other.width;
+        height = other.height;
+        maskX = other.maskX;
+        maskY = other.maskY;
+        slots = other.slots;
+        linkNeighbors();
+    }
+    return *this;
+}
+
+void ChunkGrid::linkNeighbors() {
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            ChunkSlot& slot = slots[y * width + x];
+            slot.neighbors[ChunkSlot::LEFT] = &slots[y * width + ((x - 1) & maskX)];
+            slot.neighbors[ChunkSlot::RIGHT] = &slots[y * width + ((x + 1) & maskX)];
+            slot.neighbors[ChunkSlot::UP] = &slots[((y - 1) & maskY) * width + x];
+            slot.neighbors[ChunkSlot::DOWN] = &slots[((y + 1) & maskY) * width + x];
+        }
+    }
+}
+
+const Chunk* ChunkGrid::neighbor(const ChunkSlot& slot, ChunkSlot::Direction dir) const {
+    static const int offsetX[4] = {-1, 1, 0, 0};
+    static const int offsetY[4] = {0, 0, -1, 1};
+    const ChunkSlot* next = slot.neighbors[dir];
+    return next->holds(slot.chunkX + offsetX[dir], slot.chunkY + offsetY[dir]) ? &next->chunk : nullptr;
+}
+
+bool ChunkGrid::markPending(int chunkX, int chunkY) {
+    ChunkSlot& slot = slotFor(chunkX, chunkY);
+    if (slot.holds(chunkX, chunkY) || slot.isPending(chunkX, chunkY)) {
+        return false;
+    }
+    slot.pendingX = chunkX;
+    slot.pendingY = chunkY;
+    return true;
+}
+
+Chunk& ChunkGrid::store(int chunkX, int chunkY, Chunk& chunk) {
+    ChunkSlot& slot = slotFor(chunkX, chunkY);
+    slot.chunkX = chunkX;
+    slot.chunkY = chunkY;
+    if (slot.isPending(chunkX, chunkY)) {
+        slot.pendingX = slot.pendingY = ChunkSlot::EMPTY;
+    }
+    std::swap(slot.chunk, chunk);
+    return slot.chunk;
+}
+
+void ChunkGrid::clear() {
+    for (auto& slot : slots) {
+        slot.chunkX = slot.chunkY = ChunkSlot::EMPTY;
+        slot.pendingX = slot.pendingY = ChunkSlot::EMPTY;
+    }
+}
+
+void ChunkGrid::slideTo(int startX, int endX, int startY, int endY, ChunkCache* evictTo) {
+    for (auto& slot : slots) {
+        bool outside = slot.chunkX < startX || slot.chunkX > endX || slot.chunkY < startY || slot.chunkY > endY;
+        if (outside && !slot.isEmpty()) {
+            if (evictTo) {
+                evictTo->put(slot.chunkX, slot.chunkY, slot.chunk);
+            }
+            slot.chunkX = slot.chunkY = ChunkSlot::EMPTY;
+        }
+        if (slot.pendingX < startX || slot.pendingX > endX || slot.pendingY < startY || slot.pendingY > endY) {
+            slot.pendingX = slot.pendingY = ChunkSlot::EMPTY;
+        }
+    }
+
+    int spanX = endX - startX + 1;
+    int spanY = endY - startY + 1;
+    if (spanX > width || spanY > height) {
+        resize(std::max(width, spanX), std::max(height, spanY));
+    }
+}
+
+void ChunkGrid::resize(int newWidth, int newHeight) {
+    std::vector<ChunkSlot> oldSlots;
+    oldSlots.swap(slots);
+
+    width = nextPowerOfTwo(newWidth);
+    height = nextPowerOfTwo(newHeight);
+    maskX = width - 1;
+    maskY = height - 1;
+    slots.resize(width * height);
+    clear();
+    linkNeighbors();
+
+    for (auto& slot : oldSlots) {
+        if (!slot.isEmpty()) {
+            store(slot.chunkX, slot.chunkY, slot.chunk);
+        }
+        if (slot.pendingX != ChunkSlot::EMPTY) {
+            markPending(slot.pendingX, slot.pendingY);
+        }
+    }
+}
+
+int ChunkGrid::getLoadedCount() const {
+    int count = 0;
+    for (const auto& slot : slots) {
+        if (!slot.isEmpty()) ++count;
+    }
+    return count;
+}
@@ -0,0 +1,82 @@
+#ifndef CHUNKGRID_H
+#define CHUNKGRID_H
+
+#include "Chunk.h"
+#include "ChunkCache.h"
+#include <vector>
+#include <climits>
+
+// One cell of the chunk ring. Slots are reused as the window slides, so the
+// chunk coordinates tell which chunk (if any) currently lives here.
+struct ChunkSlot {
+    enum Direction { LEFT, RIGHT, UP, DOWN };
+
+    int chunkX;
+    int chunkY;
+    int pendingX; // Chunk requested for this slot but not generated yet
+    int pendingY;
+    Chunk chunk;
+    ChunkSlot* neighbors[4]; // Adjacent slots in the ring, indexed by Direction
+
+    bool holds(int x, int y) const { return chunkX == x && chunkY == y; }
+    bool isEmpty() const { return chunkX == EMPTY; }
+    bool isPending(int x, int y) const { return pendingX == x && pendingY == y; }
+
+    static const int EMPTY = INT_MIN;
+};
+
+// Toroidal grid of chunk slots that slides with the camera. A chunk at
+// (chunkX, chunkY) can only ever live in slot (chunkX mod width, chunkY mod
+// height), so lookups are a mask, an index and a coordinate compare.
+class ChunkGrid {
+public:
+    ChunkGrid(int width = 8, int height = 8);
+    ChunkGrid(const ChunkGrid& other);
+    ChunkGrid& operator=(const ChunkGrid& other);
+    ChunkGrid(ChunkGrid&& other) = default;
+    ChunkGrid& operator=(ChunkGrid&& other) = default;
+
+    ChunkSlot* find(int chunkX, int chunkY) {
+        ChunkSlot& slot = slotFor(chunkX, chunkY);
+        return slot.holds(chunkX, chunkY) ? &slot : nullptr;
+    }
+    const ChunkSlot* find(int chunkX, int chunkY) const {
+        const ChunkSlot& slot = slots[(chunkY & maskY) * width + (chunkX & maskX)];
+        return slot.holds(chunkX, chunkY) ? &slot : nullptr;
+    }
+
+    // Returns the chunk next to the one in `slot`, or nullptr if it is not loaded
+    const Chunk* neighbor(const ChunkSlot& slot, ChunkSlot::Direction dir) const;
+
+    // Reserves the chunk's slot for a generation request; false if the chunk is
+    // already loaded or already pending
+    bool markPending(int chunkX, int chunkY);
+    bool isPending(int chunkX, int chunkY) const {
+        return slots[(chunkY & maskY) * width + (chunkX & maskX)].isPending(chunkX, chunkY);
+    }
+
+    // Swaps `chunk` into the slot; `chunk` comes back holding the slot's old
+    // tile buffer (possibly empty) so the caller can recycle it
+    Chunk& store(int chunkX, int chunkY, Chunk& chunk);
+    void clear();
+
+    // Drops every chunk and pending request outside the inclusive window and grows the ring if the
+    // window no longer fits, so the window's chunks never collide in a slot.
+    // Dropped chunks are handed to `evictTo` when one is given.
+    void slideTo(int startX, int endX, int startY, int endY, ChunkCache* evictTo = nullptr);
+
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+    int getLoadedCount() const;
+
+private:
+    ChunkSlot& slotFor(int chunkX, int chunkY) { return slots[(chunkY & maskY) * width + (chunkX & maskX)]; }
+    void resize(int newWidth, int newHeight);
+    void linkNeighbors();
+
+    int width, height;
+    int maskX, maskY;
+    std::vector<ChunkSlot> slots;
+};
+
+#endif
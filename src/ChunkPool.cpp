@@ -0,0 +1,47 @@
+#include "ChunkPool.h"
+#include <utility>
+
+ChunkPool::ChunkPool() : allocations(0), reuses(0) {
+}
+
+void ChunkPool::acquire(Chunk& chunk) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!freeBuffers.empty()) {
+            chunk.tiles.swap(freeBuffers.back());
+            freeBuffers.pop_back();
+            ++reuses;
+            return;
+        }
+        ++allocations;
+    }
+    // Allocate outside the lock; other threads only need the free list
+    chunk.tiles.assign(Chunk::AREA, GRASS);
+}
+
+void ChunkPool::release(Chunk& chunk) {
+    // Buffers of another size (or none at all) are not worth keeping
+    if (chunk.tiles.size() != static_cast<size_t>(Chunk::AREA)) {
+        std::vector<Uint8>().swap(chunk.tiles);
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    freeBuffers.push_back(std::vector<Uint8>());
+    freeBuffers.back().swap(chunk.tiles);
+}
+
+void ChunkPool::reserve(int count) {
+    std::lock_guard<std::mutex> lock(mutex);
+    freeBuffers.reserve(count);
+    while (static_cast<int>(freeBuffers.size()) < count) {
+        freeBuffers.push_back(std::vector<Uint8>(Chunk::AREA, GRASS));
+        ++allocations;
+    }
+}
+
+ChunkPool::Stats ChunkPool::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    Stats stats = {allocations, reuses, static_cast<int>(freeBuffers.size())};
+    return stats;
+}
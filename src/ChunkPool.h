@@ -0,0 +1,40 @@
+#ifndef CHUNKPOOL_H
+#define CHUNKPOOL_H
+
+#include "Chunk.h"
+#include <SDL.h>
+#include <vector>
+#include <mutex>
+
+// Recycles chunk tile buffers so streaming chunks in and out does not touch
+// the heap once the pool has warmed up. Shared by the main thread and the
+// generation workers, so every call is locked (briefly: it only swaps buffers).
+class ChunkPool {
+public:
+    struct Stats {
+        int allocations; // Buffers created because the free list was empty
+        int reuses;      // Buffers handed out from the free list
+        int available;   // Buffers currently waiting in the free list
+    };
+
+    ChunkPool();
+    ChunkPool(const ChunkPool&) = delete;
+    ChunkPool& operator=(const ChunkPool&) = delete;
+
+    // Gives `chunk` a tile buffer of Chunk::AREA tiles
+    void acquire(Chunk& chunk);
+    // Takes back the chunk's tile buffer, leaving the chunk empty
+    void release(Chunk& chunk);
+    // Fills the free list up to `count` buffers
+    void reserve(int count);
+
+    Stats getStats() const;
+
+private:
+    std::vector<std::vector<Uint8>> freeBuffers;
+    int allocations;
+    int reuses;
+    mutable std::mutex mutex;
+};
+
+#endif
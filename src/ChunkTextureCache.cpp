@@ -0,0 +1,156 @@
+#include "ChunkTextureCache.h"
+#include "RendererSupport.h"
+#include <iostream>
+
+namespace {
+const size_t TEXTURE_BYTES = static_cast<size_t>(ChunkTextureCache::PIXELS) * ChunkTextureCache::PIXELS * 4;
+}
+
+ChunkTextureCache::ChunkTextureCache(size_t budgetBytes)
+    : renderer(nullptr), budgetBytes(budgetBytes), frame(0), supported(false), bakes(0), hits(0) {
+}
+
+ChunkTextureCache::~ChunkTextureCache() {
+    clear();
+}
+
+void ChunkTextureCache::beginFrame(SDL_Renderer* newRenderer) {
+    if (newRenderer != renderer) {
+        clear();
+        renderer = newRenderer;
+        supported = renderer && SDL_RenderTargetSupported(renderer) && RendererSupport::fitsTexture(renderer, PIXELS, PIXELS);
+    }
+    ++frame;
+}
+
+SDL_Texture* ChunkTextureCache::acquire(int chunkX, int chunkY, const Chunk& chunk) {
+    if (!supported) return nullptr;
+
+    Entry* entry = find(chunkX, chunkY);
+    if (!entry) {
+        entry = allocate();
+        if (!entry) return nullptr;
+        entry->chunkX = chunkX;
+        entry->chunkY = chunkY;
+        entry->valid = false;
+    }
+    entry->lastUse = frame;
+
+    if (entry->valid) {
+        ++hits;
+    } else if (!bake(*entry, chunk)) {
+        return nullptr;
+    }
+    return entry->texture;
+}
+
+ChunkTextureCache::Entry* ChunkTextureCache::find(int chunkX, int chunkY) {
+    // Only a screenful of chunks fits in any sensible budget, so a scan is enough
+    for (auto& entry : entries) {
+        if (entry.chunkX == chunkX && entry.chunkY == chunkY) {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+ChunkTextureCache::Entry* ChunkTextureCache::allocate() {
+    if ((entries.size() + 1) * TEXTURE_BYTES <= budgetBytes) {
+        SDL_Texture* texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, PIXELS, PIXELS);
+        if (texture) {
+            // Chunks are opaque, so skip blending when drawing them
+            SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_NONE);
+            Entry entry = {0, 0, texture, 0, false};
+            entries.push_back(entry);
+            return &entries.back();
+        }
+        // Out of texture memory: stop growing and recycle what we have
+        std::cerr << "Failed to create chunk texture: " << SDL_GetError() << std::endl;
+        budgetBytes = entries.size() * TEXTURE_BYTES;
+    }
+
+    // Reuse the least recently drawn texture, but never one already drawn this frame
+    Entry* oldest = nullptr;
+    for (auto& entry : entries) {
+        if (entry.lastUse != frame && (!oldest || entry.lastUse < oldest->lastUse)) {
+            oldest = &entry;
+        }
+    }
+    return oldest;
+}
+
+bool ChunkTextureCache::bake(Entry& entry, const Chunk& chunk) {
+    SDL_Texture* previousTarget = SDL_GetRenderTarget(renderer);
+    if (SDL_SetRenderTarget(renderer, entry.texture) != 0) {
+        return false;
+    }
+
+    Uint8 r, g, b, a;
+    SDL_GetRenderDrawColor(renderer, &r, &g, &b, &a);
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0);
+    SDL_RenderClear(renderer);
+    SDL_SetRenderDrawColor(renderer, r, g, b, a);
+
+    // The whole chunk in one geometry call where available
+    bool batched = false;
+    if (batch.begin(renderer, Tile::getTilesetTexture())) {
+        for (int y = 0; y < Chunk::SIZE; ++y) {
+            for (int x = 0; x < Chunk::SIZE; ++x) {
+                batch.add(chunk.getTile(x, y), x * Tile::SIZE, y * Tile::SIZE);
+            }
+        }
+        batched = batch.flush() >= 0;
+    }
+    if (!batched) {
+        const SDL_Rect origin = {0, 0, PIXELS, PIXELS};
+        for (int y = 0; y < Chunk::SIZE; ++y) {
+            for (int x = 0; x < Chunk::SIZE; ++x) {
+                Tile::render(renderer, chunk.getTile(x, y), x * Tile::SIZE, y * Tile::SIZE, origin);
+            }
+        }
+    }
+
+    SDL_SetRenderTarget(renderer, previousTarget);
+    entry.valid = true;
+    ++bakes;
+    return true;
+}
+
+void ChunkTextureCache::invalidate(int chunkX, int chunkY) {
+    Entry* entry = find(chunkX, chunkY);
+    if (entry) {
+        entry->valid = false;
+    }
+}
+
+void ChunkTextureCache::invalidateAll() {
+    for (auto& entry : entries) {
+        entry.valid = false;
+    }
+}
+
+void ChunkTextureCache::clear() {
+    for (auto& entry : entries) {
+        SDL_DestroyTexture(entry.texture);
+    }
+    entries.clear();
+}
+
+void ChunkTextureCache::setBudget(size_t newBudget) {
+    budgetBytes = newBudget;
+    while (!entries.empty() && entries.size() * TEXTURE_BYTES > budgetBytes) {
+        SDL_DestroyTexture(entries.back().texture);
+        entries.pop_back();
+    }
+}
+
+ChunkTextureCache::Stats ChunkTextureCache::getStats() const {
+    Stats stats;
+    stats.bakes = bakes;
+    stats.hits = hits;
+    stats.textures = static_cast<int>(entries.size());
+    stats.bytes = entries.size() * TEXTURE_BYTES;
+    stats.budgetBytes = budgetBytes;
+    stats.supported = supported;
+    return stats;
+}
@@ -0,0 +1,73 @@
+#ifndef CHUNKTEXTURECACHE_H
+#define CHUNKTEXTURECACHE_H
+
+#include "Chunk.h"
+#include "TileBatch.h"
+#include <SDL.h>
+#include <vector>
+
+// Pre-rendered chunk images. A chunk is drawn into a target texture once
+// (in one TileBatch call where supported), and then every frame it is a
+// single quad. Textures are kept
+// within a byte budget, least recently drawn first out, and their GPU
+// objects are reused rather than destroyed when a slot changes chunks.
+//
+// When the renderer has no render target support, or the budget cannot fit
+// another texture, acquire() returns null and the caller draws tiles directly.
+class ChunkTextureCache {
+public:
+    struct Stats {
+        long long bakes;  // Chunks rendered into a texture
+        long long hits;   // Frames a chunk was drawn from an existing texture
+        int textures;     // Textures currently allocated
+        size_t bytes;     // Their approximate size
+        size_t budgetBytes;
+        bool supported;   // False when the renderer cannot render to textures
+    };
+
+    static const int PIXELS = Chunk::SIZE * Tile::SIZE; // Texture width and height
+
+    explicit ChunkTextureCache(size_t budgetBytes);
+    ~ChunkTextureCache();
+    ChunkTextureCache(const ChunkTextureCache&) = delete;
+    ChunkTextureCache& operator=(const ChunkTextureCache&) = delete;
+
+    // Call once per frame before acquire(); switching renderers drops every texture
+    void beginFrame(SDL_Renderer* renderer);
+    // Texture showing `chunk`, baking it first if needed, or null if the
+    // caller has to draw the tiles itself
+    SDL_Texture* acquire(int chunkX, int chunkY, const Chunk& chunk);
+    // Marks a chunk's texture stale after its tiles changed
+    void invalidate(int chunkX, int chunkY);
+    // Marks every texture stale, e.g. after the render targets were reset
+    void invalidateAll();
+    // Destroys every texture; must run before the renderer is destroyed
+    void clear();
+    void setBudget(size_t budgetBytes);
+
+    Stats getStats() const;
+
+private:
+    struct Entry {
+        int chunkX;
+        int chunkY;
+        SDL_Texture* texture;
+        unsigned int lastUse; // Frame the entry was last drawn
+        bool valid;           // Texture matches the chunk's tiles
+    };
+
+    Entry* find(int chunkX, int chunkY);
+    Entry* allocate();
+    bool bake(Entry& entry, const Chunk& chunk);
+
+    SDL_Renderer* renderer;
+    TileBatch batch;
+    std::vector<Entry> entries;
+    size_t budgetBytes;
+    unsigned int frame;
+    bool supported;
+    long long bakes;
+    long long hits;
+};
+
+#endif
@@ -0,0 +1,176 @@
+#include "ChunkWorkerPool.h"
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+ChunkWorkerPool::ChunkWorkerPool(unsigned int seed, ChunkPool& pool, RegionStore* regions, int workerCount)
+    : pool(pool), regions(regions), seed(seed), epoch(0), focusX(0), focusY(0), headingX(0), headingY(0), stopping(false), generatedCount(0) {
+    queue.reserve(64);
+    finished.reserve(16);
+
+    if (workerCount < 0) {
+        // Leave one core for the main thread
+        int cores = static_cast<int>(std::thread::hardware_concurrency());
+        workerCount = std::max(1, std::min(cores - 1, 4));
+    }
+
+    for (int i = 0; i < workerCount; ++i) {
+        workers.emplace_back(&ChunkWorkerPool::workerLoop, this);
+    }
+}
+
+ChunkWorkerPool::~ChunkWorkerPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wakeUp.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+// Lower is more urgent: squared distance from the focus's projected path,
+// weighted so that being off the path costs more than being far along it.
+// Without a heading this is plain nearest-first
+float ChunkWorkerPool::priority(const Request& request) const {
+    float dx = static_cast<float>(request.chunkX - focusX);
+    float dy = static_cast<float>(request.chunkY - focusY);
+    float lengthSq = static_cast<float>(headingX * headingX + headingY * headingY);
+
+    float along = 0.0f;
+    if (lengthSq > 0.0f) {
+        along = std::min(1.0f, std::max(0.0f, (dx * headingX + dy * headingY) / lengthSq));
+    }
+    float offX = dx - along * headingX;
+    float offY = dy - along * headingY;
+    return (offX * offX + offY * offY) * 4.0f + along * std::sqrt(lengthSq);
+}
+
+void ChunkWorkerPool::rebuildQueue() {
+    std::make_heap(queue.begin(), queue.end(), FartherFromFocus(this));
+}
+
+void ChunkWorkerPool::request(int chunkX, int chunkY) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        Request request = {chunkX, chunkY};
+        queue.push_back(request);
+        std::push_heap(queue.begin(), queue.end(), FartherFromFocus(this));
+    }
+    wakeUp.notify_one();
+}
+
+void ChunkWorkerPool::setFocus(int chunkX, int chunkY, int headingX, int headingY) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (chunkX == focusX && chunkY == focusY && headingX == this->headingX && headingY == this->headingY) return;
+    focusX = chunkX;
+    focusY = chunkY;
+    this->headingX = headingX;
+    this->headingY = headingY;
+    rebuildQueue();
+}
+
+void ChunkWorkerPool::cancelOutside(int startX, int endX, int startY, int endY) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto outside = [=](const Request& r) {
+        return r.chunkX < startX || r.chunkX > endX || r.chunkY < startY || r.chunkY > endY;
+    };
+    auto end = std::remove_if(queue.begin(), queue.end(), outside);
+    if (end != queue.end()) {
+        queue.erase(end, queue.end());
+        rebuildQueue();
+    }
+}
+
+void ChunkWorkerPool::reset(unsigned int newSeed) {
+    std::lock_guard<std::mutex> lock(mutex);
+    seed = newSeed;
+    ++epoch;
+    queue.clear();
+    for (auto& result : finished) {
+        pool.release(result.chunk);
+    }
+    finished.clear();
+}
+
+void ChunkWorkerPool::collect(std::vector<Result>& results) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (results.empty()) {
+        results.swap(finished);
+    } else {
+        for (auto& result : finished) {
+            results.push_back(std::move(result));
+        }
+        finished.clear();
+    }
+}
+
+bool ChunkWorkerPool::runPending() {
+    std::unique_lock<std::mutex> lock(mutex);
+    if (queue.empty()) return false;
+
+    if (!inlineGenerator) {
+        inlineGenerator.reset(new ChunkGenerator(seed));
+    }
+    runJob(*inlineGenerator, lock);
+    return true;
+}
+
+void ChunkWorkerPool::setRegionStore(RegionStore* store) {
+    std::lock_guard<std::mutex> lock(mutex);
+    regions = store;
+}
+
+long long ChunkWorkerPool::getGeneratedCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return generatedCount;
+}
+
+void ChunkWorkerPool::workerLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+
+    // Each worker owns its noise state, so generation runs without locks
+    ChunkGenerator generator(seed);
+    while (true) {
+        wakeUp.wait(lock, [this] { return stopping || !queue.empty(); });
+        if (stopping) return;
+        runJob(generator, lock);
+    }
+}
+
+void ChunkWorkerPool::runJob(ChunkGenerator& generator, std::unique_lock<std::mutex>& lock) {
+    std::pop_heap(queue.begin(), queue.end(), FartherFromFocus(this));
+    Request request = queue.back();
+    queue.pop_back();
+    unsigned int jobEpoch = epoch;
+    unsigned int jobSeed = seed;
+    RegionStore* jobRegions = regions;
+    lock.unlock();
+
+    if (generator.getSeed() != jobSeed) {
+        generator = ChunkGenerator(jobSeed);
+    }
+    Result result;
+    result.chunkX = request.chunkX;
+    result.chunkY = request.chunkY;
+    pool.acquire(result.chunk);
+    bool generated = false;
+    if (!jobRegions || !jobRegions->load(jobSeed, request.chunkX, request.chunkY, result.chunk)) {
+        generator.generate(request.chunkX, request.chunkY, result.chunk);
+        generated = true;
+        if (jobRegions) {
+            jobRegions->save(jobSeed, request.chunkX, request.chunkY, result.chunk);
+        }
+    }
+
+    lock.lock();
+    if (generated) {
+        ++generatedCount;
+    }
+    if (jobEpoch == epoch) {
+        finished.push_back(std::move(result));
+    } else {
+        pool.release(result.chunk);
+    }
+}
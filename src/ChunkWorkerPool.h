@@ -0,0 +1,93 @@
+#ifndef CHUNKWORKERPOOL_H
+#define CHUNKWORKERPOOL_H
+
+#include "Chunk.h"
+#include "ChunkPool.h"
+#include "RegionStore.h"
+#include "ChunkGenerator.h"
+#include <vector>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+// Generates chunks on background threads. Requests are served nearest-first
+// relative to a focus chunk (the player's), and finished chunks are handed
+// back by moving their tile storage, never by copying it. Tile buffers come
+// from the shared ChunkPool. With no worker threads the owner drives the
+// queue itself, one chunk at a time, through runPending().
+class ChunkWorkerPool {
+public:
+    static const int AUTO_WORKERS = -1;
+
+    struct Result {
+        int chunkX;
+        int chunkY;
+        Chunk chunk;
+    };
+
+    // `regions` is optional; when given, chunks are loaded from it if present
+    // and saved to it after being generated
+    ChunkWorkerPool(unsigned int seed, ChunkPool& pool, RegionStore* regions = nullptr, int workerCount = AUTO_WORKERS);
+    ~ChunkWorkerPool();
+    ChunkWorkerPool(const ChunkWorkerPool&) = delete;
+    ChunkWorkerPool& operator=(const ChunkWorkerPool&) = delete;
+
+    void request(int chunkX, int chunkY);
+    // `headingX/Y` is how far, in chunks, the focus is expected to travel
+    // soon; requests along that path are served before ones beside or behind it
+    void setFocus(int chunkX, int chunkY, int headingX = 0, int headingY = 0);
+    // Drops queued requests outside the inclusive window
+    void cancelOutside(int startX, int endX, int startY, int endY);
+    // Drops everything queued or in flight and switches workers to a new seed
+    void reset(unsigned int newSeed);
+    // Appends finished chunks to `results`; never blocks on a running job
+    void collect(std::vector<Result>& results);
+    // Serves the nearest queued request on the calling thread. Returns false
+    // if the queue was empty
+    bool runPending();
+    // Where chunks are looked up and saved from the next job on; null turns persistence off
+    void setRegionStore(RegionStore* store);
+
+    int getWorkerCount() const { return static_cast<int>(workers.size()); }
+    // Chunks generated rather than read from the region store, since construction
+    long long getGeneratedCount() const;
+
+private:
+    struct Request {
+        int chunkX;
+        int chunkY;
+    };
+
+    // Heap ordering that keeps the most urgent request on top
+    struct FartherFromFocus {
+        explicit FartherFromFocus(const ChunkWorkerPool* pool) : pool(pool) {}
+        bool operator()(const Request& a, const Request& b) const {
+            return pool->priority(a) > pool->priority(b);
+        }
+        const ChunkWorkerPool* pool;
+    };
+
+    void workerLoop();
+    // Pops the nearest request and serves it with `lock` released meanwhile
+    void runJob(ChunkGenerator& generator, std::unique_lock<std::mutex>& lock);
+    float priority(const Request& request) const;
+    void rebuildQueue();
+
+    ChunkPool& pool;
+    RegionStore* regions;
+    std::vector<std::thread> workers;
+    std::unique_ptr<ChunkGenerator> inlineGenerator; // Used by runPending()
+    mutable std::mutex mutex;
+    std::condition_variable wakeUp;
+    std::vector<Request> queue; // Binary heap, most urgent on top
+    std::vector<Result> finished;
+    unsigned int seed;
+    unsigned int epoch; // Bumped on reset so stale in-flight results are dropped
+    int focusX, focusY;
+    int headingX, headingY;
+    bool stopping;
+    long long generatedCount;
+};
+
+#endif
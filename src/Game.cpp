@@ -2,6 +2,9 @@
 #include "Player.h"
 #include "TitleScreen.h"
 #include "Camera.h"
+#include "Profiler.h"
+#include "ui/ProfilerOverlay.h"
+#include <algorithm>
 #include <iostream>
 #include <SDL_image.h>
 #include <SDL_ttf.h>
@@ -14,21 +17,23 @@ Game::Game()
       renderer(nullptr), 
       camera(new Camera(0, 0, 800, 600)), // Corrected initialization
       player(new Player(100, 100)), // Initialize player
-      FPS(60), 
-      frameDelay(1000 / FPS), 
-      frameStart(0), 
-      frameTime(0),
-      chunkSize(32), 
       seed(12345), 
       gameMap(seed), // Initialize map with seed
       seedNeedsUpdate(false),
       displaySeedMessage(true),
       seedMessageStartTime(SDL_GetTicks()),
-      lastFrameStart(SDL_GetTicks())
+      profilerOverlay(nullptr),
+      streamingBudgetMicros(2000),
+      lastCounter(SDL_GetPerformanceCounter()),
+      accumulator(0),
+      interpolation(0.0f),
+      frameRateLimit(0),
+      nextFrameCounter(0),
+      simulationTick(0)
 {
     // Initialize player and camera only once, remove re-initialization from here
-    int initialChunkX = player->getX() / (32 * chunkSize);
-    int initialChunkY = player->getY() / (32 * chunkSize);
+    int initialChunkX = std::floor(static_cast<float>(player->getX()) / (Chunk::SIZE * Tile::SIZE));
+    int initialChunkY = std::floor(static_cast<float>(player->getY()) / (Chunk::SIZE * Tile::SIZE));
 
     for (int y = initialChunkY - 1; y <= initialChunkY + 1; y++) {
         for (int x = initialChunkX - 1; x <= initialChunkX + 1; x++) {
@@ -49,22 +54,27 @@ void Game::init(const char* title, int xpos, int ypos, int width, int height, bo
     }
 
     // Initialize SDL
+    bool imagesReady = false;
     if (SDL_Init(SDL_INIT_VIDEO) == 0) {
         // Create window
         window = SDL_CreateWindow(title, xpos, ypos, width, height, flags);
         
-        // Create renderer
-        renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED);
+        // Create renderer; vsync paces frames to the display when available
+        renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC);
         if (renderer) {
+            SDL_RendererInfo info;
+            if (SDL_GetRendererInfo(renderer, &info) != 0 || !(info.flags & SDL_RENDERER_PRESENTVSYNC)) {
+                SDL_DisplayMode mode;
+                bool knownRate = SDL_GetWindowDisplayMode(window, &mode) == 0 && mode.refresh_rate > 0;
+                setFrameRateLimit(knownRate ? mode.refresh_rate : 60);
+            }
+
             // Initialize SDL_image for image loading
             int imgFlags = IMG_INIT_PNG;
             if (!(IMG_Init(imgFlags) & imgFlags)) {
                 std::cerr << "SDL_image could not initialize! SDL_image Error: " << IMG_GetError() << std::endl;
             } else {
-                // Load the tileset texture for the Tile class
-                Tile::loadTilesetTexture(renderer, ROOT_PATH "assets/tilemap.png");
-                // Load the player texture
-                Player::loadPlayerTexture(renderer, ROOT_PATH "assets/player_sprite_map.png");
+                imagesReady = true;
             }
 
             // Set draw color for renderer to white
@@ -82,49 +92,154 @@ void Game::init(const char* title, int xpos, int ypos, int width, int height, bo
         std::cerr << "SDL_ttf could not initialize! SDL_ttf Error: " << TTF_GetError() << std::endl;
     }
 
+    // Glyphs are rasterized into the atlas, so this waits for SDL_ttf
+    if (imagesReady) {
+        loadTextures();
+    }
+
     // Start accepting text input
     SDL_StartTextInput();
 
-    titleScreen = new TitleScreen(renderer, width, height);
+    titleScreen = new TitleScreen(renderer, width, height, &atlas);
+#ifdef GAME_PROFILER
+    profilerOverlay = new ProfilerOverlay(renderer, &atlas);
+#endif
+}
+
+// Packs tiles, player frames and UI glyphs into shared atlas pages, so a
+// frame draws from one texture; whatever the atlas lacks is loaded on its own
+void Game::loadTextures() {
+    Tile::addToAtlas(atlas, ROOT_PATH "assets/tilemap.png");
+    Player::addToAtlas(atlas, ROOT_PATH "assets/player_sprite_map.png");
+    UIManager::addToAtlas(atlas);
+    atlas.build(renderer);
+
+    if (!Tile::useAtlas(atlas)) {
+        Tile::loadTilesetTexture(renderer, ROOT_PATH "assets/tilemap.png");
+    }
+    if (!Player::useAtlas(atlas)) {
+        Player::loadPlayerTexture(renderer, ROOT_PATH "assets/player_sprite_map.png");
+    }
 }
 
 void Game::handleEvents() {
+    PROFILE_ZONE(ZONE_HANDLE_EVENTS);
     SDL_Event event;
-    while (SDL_PollEvent(&event)) {
-        if (event.type == SDL_QUIT) {
-            isRunning = false;
+    bool pending;
+    if (gameState == GameState::TITLE_SCREEN && !titleScreen->needsRedraw()) {
+        // Nothing to draw until input arrives or the caret blinks, so sleep
+        // in SDL rather than spinning through frames
+        int timeout = titleScreen->getIdleTimeout();
+        pending = (timeout < 0 ? SDL_WaitEvent(&event) : SDL_WaitEventTimeout(&event, timeout)) != 0;
+    } else {
+        pending = SDL_PollEvent(&event) != 0;
+    }
+
+    for (; pending; pending = SDL_PollEvent(&event) != 0) {
+        handleEvent(event);
+        if (!isRunning) {
             return;
         }
+    }
+}
 
-        if (gameState == GameState::TITLE_SCREEN) {
-            titleScreen->handleEvents(event, gameState);
-            if (gameState == GameState::GAMEPLAY) {
-                std::string userInputSeed = titleScreen->getUIManagerSeedText();
-                seed = hashStringToUnsignedInt(userInputSeed);
-                gameMap = Map(seed);
-                seedNeedsUpdate = false;
-            }
-        } else if (gameState == GameState::GAMEPLAY) {
-            if (event.type == SDL_KEYDOWN || event.type == SDL_KEYUP) {
-                player->handleInput(event);
-            }
+void Game::handleEvent(SDL_Event& event) {
+    // Everything the session reacts to, so a replay can reproduce it
+    if (gameState == GameState::GAMEPLAY) {
+        inputLog.record(simulationTick, event);
+    }
+
+    if (event.type == SDL_QUIT) {
+        isRunning = false;
+        return;
+    }
+
+    if (gameState == GameState::TITLE_SCREEN) {
+        titleScreen->handleEvents(event, gameState);
+        if (gameState == GameState::GAMEPLAY) {
+            std::string userInputSeed = titleScreen->getUIManagerSeedText();
+            seed = hashStringToUnsignedInt(userInputSeed);
+            gameMap.reset(seed);
+            seedNeedsUpdate = false;
+            startSession();
+        }
+    } else if (gameState == GameState::GAMEPLAY) {
+        if (event.type == SDL_KEYDOWN || event.type == SDL_KEYUP) {
+            player->handleInput(event);
         }
+        if (event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_F3 && profilerOverlay) {
+            profilerOverlay->toggle();
+        }
+    }
 
-        if (event.type == SDL_WINDOWEVENT && event.window.event == SDL_WINDOWEVENT_RESIZED) {
-            int newWidth = event.window.data1;
-            int newHeight = event.window.data2;
+    // Render target contents are lost when the device is reset (e.g. Direct3D)
+    if (event.type == SDL_RENDER_TARGETS_RESET || event.type == SDL_RENDER_DEVICE_RESET) {
+        gameMap.invalidateChunkTextures();
+        titleScreen->invalidate();
+    }
 
-            SDL_Rect& cameraRect = camera->getCameraRect();
-            cameraRect.w = newWidth;
-            cameraRect.h = newHeight;
+    // The window contents may be gone (uncovered, restored, resized)
+    if (event.type == SDL_WINDOWEVENT && gameState == GameState::TITLE_SCREEN) {
+        titleScreen->invalidate();
+    }
 
-            if (gameState == GameState::TITLE_SCREEN) {
-                titleScreen->handleWindowSizeChange(newWidth, newHeight);
-            }
+    if (event.type == SDL_WINDOWEVENT && event.window.event == SDL_WINDOWEVENT_RESIZED) {
+        int newWidth = event.window.data1;
+        int newHeight = event.window.data2;
+
+        SDL_Rect& cameraRect = camera->getCameraRect();
+        cameraRect.w = newWidth;
+        cameraRect.h = newHeight;
+
+        if (gameState == GameState::TITLE_SCREEN) {
+            titleScreen->handleWindowSizeChange(newWidth, newHeight);
         }
     }
 }
 
+void Game::recordInput(const std::string& filePath) {
+    inputLogPath = filePath;
+}
+
+// Ticks count from the start of each session, which is where its input log starts
+void Game::startSession() {
+    simulationTick = 0;
+    if (!inputLogPath.empty()) {
+        inputLog.start(inputLogPath, seed, TICK_RATE);
+    }
+}
+
+void Game::setStreamingBudget(Uint32 micros) {
+    streamingBudgetMicros = micros;
+}
+
+void Game::setFrameRateLimit(int fps) {
+    frameRateLimit = fps > 0 ? fps : 0;
+    nextFrameCounter = 0;
+}
+
+void Game::waitForNextFrame() {
+    // The title screen waits for input in handleEvents() instead
+    if (frameRateLimit == 0 || gameState != GameState::GAMEPLAY) return;
+
+    Uint64 frequency = SDL_GetPerformanceFrequency();
+    Uint64 now = SDL_GetPerformanceCounter();
+    nextFrameCounter += frequency / frameRateLimit;
+    if (nextFrameCounter <= now) {
+        // Behind schedule: start the next frame now rather than bunching frames to catch up
+        nextFrameCounter = now;
+        return;
+    }
+
+    // SDL_Delay can overshoot by a scheduler slice, so sleep short and spin the rest
+    Uint64 remainingMs = (nextFrameCounter - now) * 1000 / frequency;
+    if (remainingMs > 1) {
+        SDL_Delay(static_cast<Uint32>(remainingMs - 1));
+    }
+    while (SDL_GetPerformanceCounter() < nextFrameCounter) {
+    }
+}
+
 unsigned int Game::hashStringToUnsignedInt(const std::string& textSeed) {
     unsigned int hash = 0;
     for (char c : textSeed) {
@@ -134,47 +249,76 @@ unsigned int Game::hashStringToUnsignedInt(const std::string& textSeed) {
 }
 
 void Game::update() {
+    PROFILE_ZONE(ZONE_UPDATE);
+    // The title screen is paced by handleEvents() waiting for input; only
+    // the caret moves on its own
+    if (gameState == GameState::TITLE_SCREEN) {
+        titleScreen->update();
+        lastCounter = SDL_GetPerformanceCounter();
+        accumulator = 0;
+        return;
+    }
+
     if (gameState == GameState::GAMEPLAY && seedNeedsUpdate) {
         seed = static_cast<unsigned int>(time(nullptr));
-        gameMap = Map(seed);
+        gameMap.reset(seed);
         seedNeedsUpdate = false;
     }
 
-    // Capture the start time of the current frame
-    Uint32 frameStart = SDL_GetTicks();
+    // Run as many fixed steps as the time since the last update covers;
+    // the remainder carries over and positions the frame between steps
+    Uint64 frequency = SDL_GetPerformanceFrequency();
+    Uint64 now = SDL_GetPerformanceCounter();
+    Uint64 elapsed = std::min<Uint64>(now - lastCounter, frequency * MAX_TICKS_PER_FRAME / TICK_RATE);
+    lastCounter = now;
+    accumulator += elapsed * TICK_RATE;
 
-    // Calculate deltaTime using the difference between the current frame start time and the last frame start time
-    float deltaTime = (frameStart - lastFrameStart) / 1000.0f;
-    lastFrameStart = frameStart;  // Update lastFrameStart for the next frame
+    int ticks = 0;
+    for (; accumulator >= frequency; accumulator -= frequency) {
+        ++ticks;
+    }
+    simulate(ticks);
+    interpolation = static_cast<float>(accumulator) / frequency;
+}
 
-    player->update(deltaTime);
-    camera->update(player->getX(), player->getY());
+void Game::step(int ticks) {
+    simulate(ticks);
+    interpolation = 1.0f;
+    lastCounter = SDL_GetPerformanceCounter();
+    accumulator = 0;
+}
 
-    SDL_Rect cameraRect = camera->getCameraRect();
-    int visibleStartX = std::floor(static_cast<float>(cameraRect.x) / (chunkSize * 32)) - 1;
-    int visibleEndX = std::ceil(static_cast<float>(cameraRect.x + cameraRect.w) / (chunkSize * 32)) + 1;
-    int visibleStartY = std::floor(static_cast<float>(cameraRect.y) / (chunkSize * 32)) - 1;
-    int visibleEndY = std::ceil(static_cast<float>(cameraRect.y + cameraRect.h) / (chunkSize * 32)) + 1;
-
-    for (int y = visibleStartY; y <= visibleEndY; y++) {
-        for (int x = visibleStartX; x <= visibleEndX; x++) {
-            if (!gameMap.isChunkGenerated(x, y)) {
-                gameMap.generateChunk(x, y, seed);
-            }
-        }
+// Runs `ticks` fixed steps, then one frame of world streaming around the result
+void Game::simulate(int ticks) {
+    const float step = 1.0f / TICK_RATE;
+    for (int i = 0; i < ticks; ++i) {
+        player->update(step);
     }
+    simulationTick += ticks;
+    inputLog.flushIfDue(simulationTick);
 
-    gameMap.removeOutOfViewChunks(visibleStartX, visibleEndX, visibleStartY, visibleEndY);
+    camera->update(player->getX(), player->getY());
 
-    // Calculate how long the current frame took to process
-    Uint32 frameTime = SDL_GetTicks() - frameStart;
-    // If the frame processed faster than our target frame rate, delay the next frame
-    if (frameDelay > frameTime) {
-        SDL_Delay(frameDelay - frameTime);
-    }
+    SDL_Rect cameraRect = camera->getCameraRect();
+    int visibleStartX = std::floor(static_cast<float>(cameraRect.x) / (Chunk::SIZE * Tile::SIZE)) - 1;
+    int visibleEndX = std::ceil(static_cast<float>(cameraRect.x + cameraRect.w) / (Chunk::SIZE * Tile::SIZE)) + 1;
+    int visibleStartY = std::floor(static_cast<float>(cameraRect.y) / (Chunk::SIZE * Tile::SIZE)) - 1;
+    int visibleEndY = std::ceil(static_cast<float>(cameraRect.y + cameraRect.h) / (Chunk::SIZE * Tile::SIZE)) + 1;
+
+    // Streaming work that does not fit in this frame's budget carries over to the next one
+    int playerChunkX = std::floor(static_cast<float>(player->getX()) / (Chunk::SIZE * Tile::SIZE));
+    int playerChunkY = std::floor(static_cast<float>(player->getY()) / (Chunk::SIZE * Tile::SIZE));
+    gameMap.setStreamingVelocity(player->getVelocityX(), player->getVelocityY());
+    gameMap.streamChunks(visibleStartX, visibleEndX, visibleStartY, visibleEndY,
+                         playerChunkX, playerChunkY, streamingBudgetMicros);
 }
 
 void Game::render() {
+    // Leave an unchanged title screen as it was presented
+    if (gameState == GameState::TITLE_SCREEN && !titleScreen->needsRedraw()) {
+        return;
+    }
+
     SDL_RenderClear(renderer);
 
     switch (gameState) {
@@ -190,19 +334,45 @@ void Game::render() {
                 displaySeedMessage = false;
             }
 
+            // Follow the player where it is drawn, between the last two steps
+            camera->update(player->getRenderX(interpolation), player->getRenderY(interpolation));
             SDL_Rect cameraRect = camera->getCameraRect();
             gameMap.render(renderer, cameraRect);
-            player->render(renderer, cameraRect);
+            player->render(renderer, cameraRect, interpolation);
+
+#ifdef GAME_PROFILER
+            Profiler::setCounter(COUNTER_LOADED_CHUNKS, gameMap.getLoadedChunkCount());
+            Profiler::setCounter(COUNTER_DRAW_CALLS, gameMap.getRenderStats().drawCalls + 1); // The player is one copy
+            if (profilerOverlay) {
+                profilerOverlay->render();
+            }
+#endif
 
-            SDL_RenderPresent(renderer);
+            {
+                PROFILE_ZONE(ZONE_PRESENT);
+                SDL_RenderPresent(renderer);
+            }
+#ifdef GAME_PROFILER
+            Profiler::endFrame();
+#endif
             break;
     }
 }
 
 void Game::clean() {
+    inputLog.finish(simulationTick);
+#ifdef GAME_PROFILER
+    if (Profiler::getFrameCount() > 0) {
+        Profiler::writeCsv(ROOT_PATH "profile.csv");
+    }
+#endif
+    delete profilerOverlay;
+    profilerOverlay = nullptr;
     delete titleScreen;
+    gameMap.freeChunkTextures();
     Tile::freeTilesetTexture();
     Player::destroyTexture();
+    atlas.clear();
     SDL_StopTextInput();
     TTF_Quit();
     SDL_DestroyWindow(window);
@@ -214,7 +384,11 @@ bool Game::running() {
     return isRunning;
 }
 
+void Game::setGameState(GameState newState) {
+    gameState = newState;
+}
+
 void Game::setSeed(unsigned int newSeed) {
     seed = newSeed;
-    gameMap = Map(seed); // Reinitialize the map with the new seed
+    gameMap.reset(seed); // Reinitialize the map with the new seed
 }
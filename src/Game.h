@@ -6,21 +6,48 @@
 #include "Player.h"
 #include "Map.h"
 #include "Camera.h"
+#include "TextureAtlas.h"
+#include "InputLog.h"
+#include <string>
 
 class TitleScreen;  // Forward declaration of TitleScreen
+class ProfilerOverlay;
 
 class Game {
 public:
+    static const int TICK_RATE = 60;          // Simulation steps per second
+    static const int MAX_TICKS_PER_FRAME = 15; // A longer stall (a quarter second) is dropped rather than replayed
+
     Game();
     ~Game();
     void init(const char* title, int xpos, int ypos, int width, int height, bool fullscreen);
     void handleEvents();
+    // Handles one event as handleEvents() does; replays feed logged events through here
+    void handleEvent(SDL_Event& event);
     void update();
     void render();
     void clean();
     bool running();
     void setGameState(GameState newState);
     void setSeed(unsigned int newSeed);
+    // Time the main thread may spend on world streaming each frame
+    void setStreamingBudget(Uint32 micros);
+    // Most frames drawn per second, 0 for no limit. Defaults to the display's
+    // refresh rate when the renderer has no vsync, and to no limit when it has
+    void setFrameRateLimit(int fps);
+    // Advances exactly `ticks` fixed steps, however much time has passed, and
+    // draws the latest one; for scripted runs that must not depend on timing
+    void step(int ticks);
+    // Sleeps until the next frame is due under the frame rate limit
+    void waitForNextFrame();
+    // Logs the input of the gameplay sessions started from now on to `filePath`,
+    // with the seed and the tick each event was handled at, for replaying them
+    void recordInput(const std::string& filePath);
+    // Fixed steps simulated since the gameplay session started
+    Uint32 getTick() const { return simulationTick; }
+    unsigned int getSeed() const { return seed; }
+    Player& getPlayer() { return *player; }
+    Map& getMap() { return gameMap; }
 
 private:
     GameState gameState;
@@ -30,19 +57,27 @@ private:
     SDL_Renderer* renderer;
     Camera* camera; // Camera class pointer
     Player* player;
-    const int FPS = 60;
-    const int frameDelay = 1000 / FPS;
-    Uint32 frameStart;
-    int frameTime;
-    Map gameMap;
-    int chunkSize;
     unsigned int seed;
+    Map gameMap;
     bool seedNeedsUpdate;
     bool displaySeedMessage;
     Uint32 seedMessageStartTime;
     const Uint32 seedMessageDuration = 5000; // 5 seconds
     unsigned int hashStringToUnsignedInt(const std::string& textSeed);
-    Uint32 lastFrameStart;
+    void loadTextures();
+    void simulate(int ticks);
+    void startSession();
+    TextureAtlas atlas; // Tiles, player frames and UI glyphs
+    ProfilerOverlay* profilerOverlay; // Toggled with F3; null unless built with the profiler
+    Uint32 streamingBudgetMicros;
+    Uint64 lastCounter;   // Performance counter at the previous update()
+    Uint64 accumulator;   // Unsimulated time, in counter ticks times TICK_RATE
+    float interpolation;  // Fraction of a step between the last tick and now
+    int frameRateLimit;
+    Uint64 nextFrameCounter; // When waitForNextFrame() lets the next frame start
+    Uint32 simulationTick;
+    InputLog inputLog;
+    std::string inputLogPath; // Empty when input is not recorded
 };
 
 #endif
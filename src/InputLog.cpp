@@ -0,0 +1,296 @@
+#include "InputLog.h"
+#include <cstring>
+#include <iostream>
+#include <iterator>
+
+namespace {
+
+const char MAGIC[4] = {'G', 'I', 'N', 'P'};
+const Uint32 HEADER_SIZE = 16;
+const size_t FLUSH_BYTES = 4096;
+
+// Record kinds; the numbers are part of the format
+enum RecordKind : Uint8 {
+    KIND_END = 0,
+    KIND_KEY_DOWN = 1,
+    KIND_KEY_UP = 2,
+    KIND_MOUSE_DOWN = 3,
+    KIND_MOUSE_UP = 4,
+    KIND_TEXT = 5,
+    KIND_WINDOW = 6,
+    KIND_QUIT = 7,
+    KIND_TARGETS_RESET = 8,
+    KIND_DEVICE_RESET = 9
+};
+
+void putU32(Uint8* out, Uint32 value) {
+    out[0] = static_cast<Uint8>(value);
+    out[1] = static_cast<Uint8>(value >> 8);
+    out[2] = static_cast<Uint8>(value >> 16);
+    out[3] = static_cast<Uint8>(value >> 24);
+}
+
+Uint32 getU32(const Uint8* in) {
+    return in[0] | (in[1] << 8) | (in[2] << 16) | (static_cast<Uint32>(in[3]) << 24);
+}
+
+// Small negative coordinates stay short as varints
+Uint32 zigzag(Sint32 value) {
+    return (static_cast<Uint32>(value) << 1) ^ static_cast<Uint32>(value >> 31);
+}
+
+Sint32 unzigzag(Uint32 value) {
+    return static_cast<Sint32>(value >> 1) ^ -static_cast<Sint32>(value & 1);
+}
+
+// Reads from a loaded log; every read past the end fails the whole reader
+class Reader {
+public:
+    Reader(const std::vector<Uint8>& data, size_t offset) : data(data), offset(offset), failed(false) {}
+
+    bool atEnd() const { return offset >= data.size(); }
+    bool ok() const { return !failed; }
+
+    Uint8 byte() {
+        if (offset >= data.size()) {
+            failed = true;
+            return 0;
+        }
+        return data[offset++];
+    }
+
+    Uint32 varint() {
+        Uint32 value = 0;
+        for (int shift = 0; shift < 35; shift += 7) {
+            Uint8 next = byte();
+            value |= static_cast<Uint32>(next & 0x7F) << shift;
+            if (!(next & 0x80)) return value;
+        }
+        failed = true;
+        return 0;
+    }
+
+private:
+    const std::vector<Uint8>& data;
+    size_t offset;
+    bool failed;
+};
+
+} // namespace
+
+InputLog::InputLog() : lastTick(0), tickRate(0), bufferedSince(0) {
+}
+
+InputLog::~InputLog() {
+    if (isRecording()) {
+        finish(lastTick);
+    }
+}
+
+bool InputLog::start(const std::string& filePath, unsigned int seed, Uint32 tickRate) {
+    if (isRecording()) {
+        finish(lastTick);
+    }
+    file.open(filePath.c_str(), std::ios::binary | std::ios::trunc);
+    if (!file) {
+        std::cerr << "Could not record input to " << filePath << std::endl;
+        return false;
+    }
+
+    Uint8 header[HEADER_SIZE];
+    memcpy(header, MAGIC, 4);
+    putU32(header + 4, FORMAT_VERSION);
+    putU32(header + 8, seed);
+    putU32(header + 12, tickRate);
+    file.write(reinterpret_cast<const char*>(header), HEADER_SIZE);
+    file.flush();
+    buffer.clear();
+    lastTick = 0;
+    this->tickRate = tickRate;
+    return true;
+}
+
+void InputLog::putVarint(Uint32 value) {
+    while (value >= 0x80) {
+        buffer.push_back(static_cast<Uint8>(value | 0x80));
+        value >>= 7;
+    }
+    buffer.push_back(static_cast<Uint8>(value));
+}
+
+void InputLog::putRecordHeader(Uint32 tick, Uint8 kind) {
+    if (buffer.empty()) {
+        bufferedSince = tick;
+    }
+    putVarint(tick - lastTick);
+    buffer.push_back(kind);
+    lastTick = tick;
+}
+
+void InputLog::record(Uint32 tick, const SDL_Event& event) {
+    if (!isRecording()) return;
+
+    switch (event.type) {
+        case SDL_KEYDOWN:
+        case SDL_KEYUP:
+            putRecordHeader(tick, event.type == SDL_KEYDOWN ? KIND_KEY_DOWN : KIND_KEY_UP);
+            putVarint(static_cast<Uint32>(event.key.keysym.sym));
+            putVarint(static_cast<Uint32>(event.key.keysym.scancode));
+            putVarint(event.key.keysym.mod);
+            buffer.push_back(event.key.repeat);
+            break;
+        case SDL_MOUSEBUTTONDOWN:
+        case SDL_MOUSEBUTTONUP:
+            putRecordHeader(tick, event.type == SDL_MOUSEBUTTONDOWN ? KIND_MOUSE_DOWN : KIND_MOUSE_UP);
+            buffer.push_back(event.button.button);
+            buffer.push_back(event.button.clicks);
+            putVarint(zigzag(event.button.x));
+            putVarint(zigzag(event.button.y));
+            break;
+        case SDL_TEXTINPUT: {
+            Uint8 length = static_cast<Uint8>(strnlen(event.text.text, SDL_TEXTINPUTEVENT_TEXT_SIZE - 1));
+            putRecordHeader(tick, KIND_TEXT);
+            buffer.push_back(length);
+            buffer.insert(buffer.end(), event.text.text, event.text.text + length);
+            break;
+        }
+        case SDL_WINDOWEVENT:
+            putRecordHeader(tick, KIND_WINDOW);
+            buffer.push_back(event.window.event);
+            putVarint(zigzag(event.window.data1));
+            putVarint(zigzag(event.window.data2));
+            break;
+        case SDL_QUIT:
+            putRecordHeader(tick, KIND_QUIT);
+            break;
+        case SDL_RENDER_TARGETS_RESET:
+            putRecordHeader(tick, KIND_TARGETS_RESET);
+            break;
+        case SDL_RENDER_DEVICE_RESET:
+            putRecordHeader(tick, KIND_DEVICE_RESET);
+            break;
+        default:
+            return; // Nothing in the game reacts to it
+    }
+
+    flushIfDue(tick);
+}
+
+void InputLog::flushIfDue(Uint32 tick) {
+    if (buffer.empty() || (buffer.size() < FLUSH_BYTES && tick - bufferedSince < tickRate)) return;
+    writeBuffer();
+}
+
+// Hands the records to the OS, where they survive the game crashing
+void InputLog::writeBuffer() {
+    file.write(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+    file.flush();
+    buffer.clear();
+}
+
+void InputLog::finish(Uint32 tick) {
+    if (!isRecording()) return;
+
+    putRecordHeader(tick < lastTick ? lastTick : tick, KIND_END);
+    writeBuffer();
+    file.close();
+    if (file.fail()) {
+        std::cerr << "Could not finish the input log" << std::endl;
+    }
+}
+
+bool InputLog::load(const std::string& filePath, Session& session) {
+    std::ifstream in(filePath.c_str(), std::ios::binary);
+    if (!in) {
+        std::cerr << "Could not open input log " << filePath << std::endl;
+        return false;
+    }
+    std::vector<Uint8> data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    if (data.size() < HEADER_SIZE || memcmp(data.data(), MAGIC, 4) != 0) {
+        std::cerr << filePath << " is not an input log" << std::endl;
+        return false;
+    }
+    if (getU32(data.data() + 4) != FORMAT_VERSION) {
+        std::cerr << filePath << " has input log version " << getU32(data.data() + 4) << ", expected "
+                  << FORMAT_VERSION << std::endl;
+        return false;
+    }
+    session.seed = getU32(data.data() + 8);
+    session.tickRate = getU32(data.data() + 12);
+    session.entries.clear();
+
+    Reader reader(data, HEADER_SIZE);
+    Uint32 tick = 0;
+    while (!reader.atEnd()) {
+        tick += reader.varint();
+        Uint8 kind = reader.byte();
+        if (!reader.ok()) break;
+        if (kind == KIND_END) {
+            session.endTick = tick;
+            return true;
+        }
+
+        Entry entry;
+        entry.tick = tick;
+        SDL_Event& event = entry.event;
+        memset(&event, 0, sizeof(event));
+        switch (kind) {
+            case KIND_KEY_DOWN:
+            case KIND_KEY_UP:
+                event.type = kind == KIND_KEY_DOWN ? SDL_KEYDOWN : SDL_KEYUP;
+                event.key.state = kind == KIND_KEY_DOWN ? SDL_PRESSED : SDL_RELEASED;
+                event.key.keysym.sym = static_cast<SDL_Keycode>(reader.varint());
+                event.key.keysym.scancode = static_cast<SDL_Scancode>(reader.varint());
+                event.key.keysym.mod = static_cast<Uint16>(reader.varint());
+                event.key.repeat = reader.byte();
+                break;
+            case KIND_MOUSE_DOWN:
+            case KIND_MOUSE_UP:
+                event.type = kind == KIND_MOUSE_DOWN ? SDL_MOUSEBUTTONDOWN : SDL_MOUSEBUTTONUP;
+                event.button.state = kind == KIND_MOUSE_DOWN ? SDL_PRESSED : SDL_RELEASED;
+                event.button.button = reader.byte();
+                event.button.clicks = reader.byte();
+                event.button.x = unzigzag(reader.varint());
+                event.button.y = unzigzag(reader.varint());
+                break;
+            case KIND_TEXT: {
+                Uint8 length = reader.byte();
+                if (length >= SDL_TEXTINPUTEVENT_TEXT_SIZE) {
+                    std::cerr << filePath << " has a corrupt text record" << std::endl;
+                    return false;
+                }
+                event.type = SDL_TEXTINPUT;
+                for (Uint8 i = 0; i < length; ++i) {
+                    event.text.text[i] = static_cast<char>(reader.byte());
+                }
+                break;
+            }
+            case KIND_WINDOW:
+                event.type = SDL_WINDOWEVENT;
+                event.window.event = reader.byte();
+                event.window.data1 = unzigzag(reader.varint());
+                event.window.data2 = unzigzag(reader.varint());
+                break;
+            case KIND_QUIT:
+                event.type = SDL_QUIT;
+                break;
+            case KIND_TARGETS_RESET:
+                event.type = SDL_RENDER_TARGETS_RESET;
+                break;
+            case KIND_DEVICE_RESET:
+                event.type = SDL_RENDER_DEVICE_RESET;
+                break;
+            default:
+                std::cerr << filePath << " has an unknown record kind " << static_cast<int>(kind) << std::endl;
+                return false;
+        }
+        if (!reader.ok()) break;
+        session.entries.push_back(entry);
+    }
+
+    // A session that crashed never wrote its END record; replay what made it to disk
+    std::cerr << filePath << " is truncated; replaying its first " << session.entries.size() << " events"
+              << std::endl;
+    session.endTick = session.entries.empty() ? 0 : session.entries.back().tick;
+    return true;
+}
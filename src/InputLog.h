@@ -0,0 +1,66 @@
+#ifndef INPUTLOG_H
+#define INPUTLOG_H
+
+#include <SDL.h>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// A compact binary log of the input one gameplay session consumed, each
+// event tagged with the simulation tick it was handled before, plus the seed
+// the world was generated from. Replaying the events at their ticks from the
+// same seed reproduces the session exactly, however fast it is run.
+//
+// Layout, little-endian: "GINP", format version, seed and tick rate as
+// 32-bit words; then one record per event: the ticks since the previous
+// record as a varint, a kind byte and the fields that kind needs. An END
+// record carries the tick the session stopped at. Records reach the file
+// within a second of ticks, so a crash loses at most the last second.
+class InputLog {
+public:
+    static const Uint32 FORMAT_VERSION = 1;
+
+    struct Entry {
+        Uint32 tick;
+        SDL_Event event;
+    };
+
+    // What a log holds once read back
+    struct Session {
+        unsigned int seed;
+        Uint32 tickRate;
+        Uint32 endTick;
+        std::vector<Entry> entries;
+    };
+
+    InputLog();
+    ~InputLog();
+    InputLog(const InputLog&) = delete;
+    InputLog& operator=(const InputLog&) = delete;
+
+    // Creates or truncates `filePath`; false, with the reason on stderr, if it cannot be written
+    bool start(const std::string& filePath, unsigned int seed, Uint32 tickRate);
+    // Appends the event if it is of a kind the game reacts to; others are skipped
+    void record(Uint32 tick, const SDL_Event& event);
+    // Writes out and flushes buffered records once the oldest is a second of
+    // ticks old; record() checks too, but only when there is input
+    void flushIfDue(Uint32 tick);
+    // Writes the END record and closes the file
+    void finish(Uint32 tick);
+    bool isRecording() const { return file.is_open(); }
+
+    static bool load(const std::string& filePath, Session& session);
+
+private:
+    void putVarint(Uint32 value);
+    void putRecordHeader(Uint32 tick, Uint8 kind);
+    void writeBuffer();
+
+    std::ofstream file;
+    std::vector<Uint8> buffer; // Encoded records not yet written
+    Uint32 lastTick;
+    Uint32 tickRate;
+    Uint32 bufferedSince; // Tick of the oldest record in the buffer
+};
+
+#endif
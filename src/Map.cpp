@@ -1,175 +1,409 @@
 #include "Map.h"
-#include "../dep/FastNoiseLite.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
 #include <iostream>
 
 const int Map::numberOfChunksWidth = 100;  // Example value for map width
 const int Map::numberOfChunksHeight = 100; // Example value for map height
 
-Map::Map(unsigned int seed) : seed(seed), chunkSize(32),
-    grasslandThreshold(-0.2), // Adjust this for more Grassland
-    snowThreshold(-0.6) {     // Adjust this for more Snow
-    // Noise setup
-    noise.SetNoiseType(FastNoiseLite::NoiseType_Perlin);
-    biomeNoise.SetNoiseType(FastNoiseLite::NoiseType_Perlin);
-    riverNoise.SetNoiseType(FastNoiseLite::NoiseType_Perlin);
-
-    // Adjusting noise parameters
-    noise.SetSeed(seed);
-    biomeNoise.SetSeed(seed + 1);
-    riverNoise.SetSeed(seed + 2);
-    riverNoise.SetFrequency(0.05);
-
+Map::Map(unsigned int seed, int streamingWorkers) : seed(seed),
+    generator(seed),
+    cache(2 * 1024 * 1024),
+    textures(64 * 1024 * 1024),
+    renderMode(RENDER_SCROLL_BUFFER),
+    evictionMargin(1),
+    prefetchHorizon(1.5f),
+    velocityX(0.0f), velocityY(0.0f),
+    viewStartX(0), viewEndX(0), viewStartY(0), viewEndY(0),
+    pool(),
+    regions(ROOT_PATH "saves/regions", seed, ChunkGenerator::VERSION),
+    workers(seed, pool, &regions, streamingWorkers),
+    nextGenerated(0) {
     loadTileProperties();
+    generatedChunks.reserve(16);
+    prefetchStats.hits = 0;
+    prefetchStats.misses = 0;
+    renderStats.drawCalls = 0;
+    renderStats.vertices = 0;
+    renderStats.tiles = 0;
+}
+
+void Map::reset(unsigned int newSeed) {
+    seed = newSeed;
+    generator = ChunkGenerator(seed);
+    workers.reset(seed);
+    regions.reset(seed);
+    chunks.clear();
+    cache.clear();
+    textures.invalidateAll();
+    scroll.invalidateAll();
+    for (size_t i = nextGenerated; i < generatedChunks.size(); ++i) {
+        pool.release(generatedChunks[i].chunk);
+    }
+    generatedChunks.clear();
+    nextGenerated = 0;
 }
 
 void Map::loadTileProperties() {
     Tile::loadTileProperties(ROOT_PATH "src/tile_props.json");
 }
 
-TileType Map::generateGrasslandTile(float noiseValue, float riverNoiseValue, float biomeValue, int x, int y) {
-    // Example implementation for grassland
-    // Adjust thresholds and logic as per your game's design
-
-    const float riverThreshold = 0.2; // Threshold for rivers
-    const float riverEdgeThreshold = 0.25; // Threshold for river edges
+void Map::generateChunk(int chunkX, int chunkY, unsigned int seed) {
+    Chunk newChunk;
+    pool.acquire(newChunk);
+    generator.generate(chunkX, chunkY, newChunk);
 
-    bool isRiver = riverNoiseValue < riverThreshold;
-    bool isRiverEdge = riverNoiseValue >= riverThreshold && riverNoiseValue < riverEdgeThreshold;
+    install(chunkX, chunkY, newChunk);
+    pool.release(newChunk);
+}
 
-    if (isRiver) {
-        return WATER; // River tile
-    } else if (isRiverEdge) {
-        return SAND; // River edge, possibly a beach
-    } else {
-        return GRASS; // Grassland
-    }
+// Stores a chunk in the grid and recycles whatever the slot held before into
+// `chunk`. Any texture of that chunk position was drawn from other tiles
+void Map::install(int chunkX, int chunkY, Chunk& chunk) {
+    chunks.store(chunkX, chunkY, chunk);
+    textures.invalidate(chunkX, chunkY);
+    scroll.invalidate(chunkX * Chunk::SIZE, chunkY * Chunk::SIZE, Chunk::SIZE, Chunk::SIZE);
 }
 
-TileType Map::generateSnowTile(float noiseValue, float biomeValue, int x, int y) {
-    // Simple implementation for snow/tundra biome
-    // You can add more complex logic for features like frozen lakes
+void Map::requestChunk(int chunkX, int chunkY) {
+    if (chunks.find(chunkX, chunkY) || chunks.isPending(chunkX, chunkY)) {
+        return;
+    }
 
-    return SNOW; // Snow tile
+    // The cache trades its chunk for a full buffer, so its entries never run dry
+    Chunk cached;
+    pool.acquire(cached);
+    if (cache.take(chunkX, chunkY, cached)) {
+        install(chunkX, chunkY, cached);
+    } else if (chunks.markPending(chunkX, chunkY)) {
+        workers.request(chunkX, chunkY);
+    }
+    pool.release(cached);
 }
 
-void Map::generateChunk(int chunkX, int chunkY, unsigned int seed) {
-    // Initialize the new chunk
-    Chunk newChunk;
-    newChunk.tiles.reserve(chunkSize);
-
-    // Temporary storage for tile types before finalizing the chunk
-    std::vector<std::vector<TileType>> tempTypes(chunkSize, std::vector<TileType>(chunkSize));
-
-    // First pass: Generate basic terrain types (grass and snow)
-    for (int y = 0; y < chunkSize; ++y) {
-        for (int x = 0; x < chunkSize; ++x) {
-            // Note: Using class-level noise objects
-            float biomeValue = this->biomeNoise.GetNoise((float)(x + chunkX * chunkSize), (float)(y + chunkY * chunkSize));
-            float noiseValue = this->noise.GetNoise((float)(x + chunkX * chunkSize), (float)(y + chunkY * chunkSize));
-            float riverNoiseValue = std::abs(this->riverNoise.GetNoise((float)(x + chunkX * chunkSize), (float)(y + chunkY * chunkSize)));
-
-            TileType type;
-            if (biomeValue > grasslandThreshold) {
-                type = generateGrasslandTile(noiseValue, riverNoiseValue, biomeValue, x, y);
-            } else {
-                type = generateSnowTile(noiseValue, biomeValue, x, y);
-            }
+void Map::setStreamingFocus(int chunkX, int chunkY) {
+    workers.setFocus(chunkX, chunkY);
+}
 
-            tempTypes[y][x] = type;
-        }
-    }
+int Map::integrateGeneratedChunks() {
+    int integrated = 0;
+    while (integrateNextChunk(integrated)) {}
+    return integrated;
+}
 
-    // Second pass: Adjust for beaches (sand) near water bodies
-    for (int y = 0; y < chunkSize; ++y) {
-        for (int x = 0; x < chunkSize; ++x) {
-            if (tempTypes[y][x] == GRASS && checkAdjacentToWater(x, y, tempTypes)) {
-                tempTypes[y][x] = SAND;
-            }
-        }
+// Hands one finished chunk to the grid, collecting a new batch from the
+// workers once the previous one is used up. Returns false if nothing was ready
+bool Map::integrateNextChunk(int& integrated) {
+    if (nextGenerated == generatedChunks.size()) {
+        generatedChunks.clear();
+        nextGenerated = 0;
+        workers.collect(generatedChunks);
+        if (generatedChunks.empty()) return false;
     }
 
-    // Finalize the chunk with the determined tile types
-    for (int y = 0; y < chunkSize; ++y) {
-        std::vector<Tile> row;
-        row.reserve(chunkSize);
-        for (int x = 0; x < chunkSize; ++x) {
-            TileType type = tempTypes[y][x];
-            row.emplace_back(type, (x + chunkX * chunkSize) * 32, (y + chunkY * chunkSize) * 32);
-        }
-        newChunk.tiles.push_back(std::move(row));
+    ChunkWorkerPool::Result& result = generatedChunks[nextGenerated++];
+    // Chunks that left the window while generating are no longer pending
+    if (chunks.isPending(result.chunkX, result.chunkY)) {
+        install(result.chunkX, result.chunkY, result.chunk);
+        ++integrated;
     }
-
-    // Store the newly generated chunk
-    chunks[std::make_pair(chunkX, chunkY)] = std::move(newChunk);
+    pool.release(result.chunk);
+    return true;
 }
 
-bool Map::checkAdjacentToWater(int x, int y, const std::vector<std::vector<TileType>>& tempTypes) {
-    for (int dy = -1; dy <= 1; ++dy) {
-        for (int dx = -1; dx <= 1; ++dx) {
-            if (dx == 0 && dy == 0) continue; // Skip the current tile
+int Map::streamChunks(int visibleStartX, int visibleEndX, int visibleStartY, int visibleEndY,
+                      int focusX, int focusY, Uint32 budgetMicros) {
+    Uint64 start = SDL_GetPerformanceCounter();
+    Uint64 budget = budgetMicros * SDL_GetPerformanceFrequency() / 1000000;
 
-            int nx = x + dx;
-            int ny = y + dy;
-            if (nx < 0 || ny < 0 || nx >= chunkSize || ny >= chunkSize) continue; // Check bounds
+    // Where the focus will be `prefetchHorizon` seconds from now, in chunks
+    float chunkPixels = static_cast<float>(Chunk::SIZE * Tile::SIZE);
+    float aheadX = velocityX * prefetchHorizon / chunkPixels;
+    float aheadY = velocityY * prefetchHorizon / chunkPixels;
+    int headingX = static_cast<int>(std::floor(focusX + 0.5f + aheadX)) - focusX;
+    int headingY = static_cast<int>(std::floor(focusY + 0.5f + aheadY)) - focusY;
 
-            if (tempTypes[ny][nx] == WATER) {
-                return true;
+    // The active window stretches along the path (plus one chunk either side)
+    // so prefetched chunks are not evicted before the view reaches them.
+    // Slide it first so new chunks never land in a slot that is still in view
+    int startX = std::min(visibleStartX, focusX + headingX - 1);
+    int endX = std::max(visibleEndX, focusX + headingX + 1);
+    int startY = std::min(visibleStartY, focusY + headingY - 1);
+    int endY = std::max(visibleEndY, focusY + headingY + 1);
+    removeOutOfViewChunks(startX, endX, startY, endY);
+
+    // Queueing is cheap, so every missing chunk is requested each frame; the
+    // workers serve the path ahead first, then the rest nearest-first
+    workers.setFocus(focusX, focusY, headingX, headingY);
+    for (int y = visibleStartY; y <= visibleEndY; y++) {
+        for (int x = visibleStartX; x <= visibleEndX; x++) {
+            requestChunk(x, y);
+        }
+    }
+    int steps = std::max(std::abs(headingX), std::abs(headingY));
+    for (int i = 1; i <= steps; ++i) {
+        int pathX = focusX + headingX * i / steps;
+        int pathY = focusY + headingY * i / steps;
+        for (int y = pathY - 1; y <= pathY + 1; y++) {
+            for (int x = pathX - 1; x <= pathX + 1; x++) {
+                requestChunk(x, y);
             }
         }
     }
-    return false;
+
+    // Integrating (or, without workers, generating) happens one chunk at a time
+    bool generateInline = workers.getWorkerCount() == 0;
+    int integrated = 0;
+    int handled = 0;
+    do {
+        if (!integrateNextChunk(integrated) && !(generateInline && workers.runPending())) break;
+        ++handled;
+    } while (SDL_GetPerformanceCounter() - start < budget);
+    return handled;
 }
 
 TileType Map::getTileAt(int x, int y) {
-    int chunkX = x / chunkSize;
-    int chunkY = y / chunkSize;
-    int tileX = x % chunkSize;
-    int tileY = y % chunkSize;
-
-    auto chunkIt = chunks.find(std::make_pair(chunkX, chunkY));
-    if (chunkIt != chunks.end()) {
-        Chunk &chunk = chunkIt->second;
-        return chunk.tiles[tileY][tileX].getType();
+    const ChunkSlot* slot = chunks.find(Chunk::chunkOf(x), Chunk::chunkOf(y));
+    if (slot) {
+        return slot->chunk.getTile(Chunk::offsetIn(x), Chunk::offsetIn(y));
     } else {
         return WATER; // Or some other default type
     }
 }
 
+bool Map::setTileAt(int x, int y, TileType type) {
+    int chunkX = Chunk::chunkOf(x);
+    int chunkY = Chunk::chunkOf(y);
+    ChunkSlot* slot = chunks.find(chunkX, chunkY);
+    if (!slot) return false;
+
+    slot->chunk.setTile(Chunk::offsetIn(x), Chunk::offsetIn(y), type);
+    textures.invalidate(chunkX, chunkY);
+    scroll.invalidate(x, y, 1, 1);
+    return true;
+}
+
 void Map::render(SDL_Renderer* renderer, SDL_Rect& camera) {
-    int startChunkX = std::floor(static_cast<float>(camera.x) / (chunkSize * 32));
-    int startChunkY = std::floor(static_cast<float>(camera.y) / (chunkSize * 32));
-    int endChunkX = std::ceil(static_cast<float>(camera.x + camera.w) / (chunkSize * 32));
-    int endChunkY = std::ceil(static_cast<float>(camera.y + camera.h) / (chunkSize * 32));
+    PROFILE_ZONE(ZONE_MAP_RENDER);
+    int startChunkX = std::floor(static_cast<float>(camera.x) / (Chunk::SIZE * Tile::SIZE));
+    int startChunkY = std::floor(static_cast<float>(camera.y) / (Chunk::SIZE * Tile::SIZE));
+    int endChunkX = std::ceil(static_cast<float>(camera.x + camera.w) / (Chunk::SIZE * Tile::SIZE));
+    int endChunkY = std::ceil(static_cast<float>(camera.y + camera.h) / (Chunk::SIZE * Tile::SIZE));
+    countPrefetchHits(startChunkX, endChunkX, startChunkY, endChunkY);
+    renderStats.drawCalls = 0;
+    renderStats.vertices = 0;
+    renderStats.tiles = 0;
+
+    if (renderMode == RENDER_SCROLL_BUFFER && scroll.render(renderer, camera, chunks)) {
+        ScrollBuffer::Stats scrolled = scroll.getStats();
+        renderStats.drawCalls = scrolled.drawCalls;
+        renderStats.vertices = scrolled.vertices;
+        renderStats.tiles = scrolled.tilesDrawn;
+        return;
+    }
+
+    textures.beginFrame(renderer);
+    long long bakes = textures.getStats().bakes;
+    bool batching = renderMode != RENDER_TILE_COPIES && batch.begin(renderer, Tile::getTilesetTexture());
 
     for (int chunkY = startChunkY; chunkY < endChunkY; ++chunkY) {
         for (int chunkX = startChunkX; chunkX < endChunkX; ++chunkX) {
-            auto it = chunks.find(std::make_pair(chunkX, chunkY));
-            if (it != chunks.end()) {
-                Chunk& chunk = it->second;
-                for (auto& row : chunk.tiles) {
-                    for (auto& tile : row) {
-                        tile.render(renderer, camera); // Assuming Tile class has a render method
-                    }
-                }
+            const ChunkSlot* slot = chunks.find(chunkX, chunkY);
+            if (!slot) {
+                renderPlaceholder(renderer, camera, chunkX, chunkY);
+                continue;
+            }
+
+            SDL_Texture* texture = nullptr;
+            if (renderMode == RENDER_SCROLL_BUFFER || renderMode == RENDER_CHUNK_TEXTURES) {
+                texture = textures.acquire(chunkX, chunkY, slot->chunk);
             }
+            if (texture) {
+                SDL_Rect dest = {chunkX * ChunkTextureCache::PIXELS - camera.x, chunkY * ChunkTextureCache::PIXELS - camera.y,
+                                 ChunkTextureCache::PIXELS, ChunkTextureCache::PIXELS};
+                SDL_RenderCopy(renderer, texture, nullptr, &dest);
+                ++renderStats.drawCalls;
+                renderStats.vertices += 4;
+            } else if (batching) {
+                batchTiles(camera, chunkX, chunkY, slot->chunk);
+            } else {
+                renderTiles(renderer, camera, chunkX, chunkY, slot->chunk);
+            }
+        }
+    }
+
+    if (batching) {
+        int vertices = batch.flush();
+        if (vertices > 0) {
+            ++renderStats.drawCalls;
+            renderStats.vertices += vertices;
         }
     }
+    renderStats.tiles += static_cast<int>(textures.getStats().bakes - bakes) * Chunk::AREA;
 }
 
-void Map::removeOutOfViewChunks(int visibleStartX, int visibleEndX, int visibleStartY, int visibleEndY) {
-    auto it = chunks.begin();
-    while (it != chunks.end()) {
-        int chunkX = it->first.first;
-        int chunkY = it->first.second;
-        if (chunkX < visibleStartX || chunkX > visibleEndX || chunkY < visibleStartY || chunkY > visibleEndY) {
-            it = chunks.erase(it);
-        } else {
-            ++it;
+void Map::setRenderMode(RenderMode mode) {
+    if (mode != renderMode) {
+        scroll.invalidateAll(); // Edits made meanwhile were not tracked
+    }
+    renderMode = mode;
+}
+
+// Range of a chunk's tiles that overlap the camera, ends exclusive
+void Map::visibleTiles(const SDL_Rect& camera, int chunkX, int chunkY, int& startX, int& endX, int& startY, int& endY) {
+    int left = camera.x - chunkX * ChunkTextureCache::PIXELS;
+    int top = camera.y - chunkY * ChunkTextureCache::PIXELS;
+    startX = std::max(0, left / Tile::SIZE);
+    startY = std::max(0, top / Tile::SIZE);
+    // std::min takes references, which would need an out-of-line Chunk::SIZE
+    int chunkTiles = Chunk::SIZE;
+    endX = std::min(chunkTiles, (left + camera.w + Tile::SIZE - 1) / Tile::SIZE);
+    endY = std::min(chunkTiles, (top + camera.h + Tile::SIZE - 1) / Tile::SIZE);
+}
+
+void Map::batchTiles(SDL_Rect& camera, int chunkX, int chunkY, const Chunk& chunk) {
+    int startX, endX, startY, endY;
+    visibleTiles(camera, chunkX, chunkY, startX, endX, startY, endY);
+    int originX = chunkX * ChunkTextureCache::PIXELS - camera.x;
+    int originY = chunkY * ChunkTextureCache::PIXELS - camera.y;
+    for (int y = startY; y < endY; ++y) {
+        for (int x = startX; x < endX; ++x) {
+            batch.add(chunk.getTile(x, y), originX + x * Tile::SIZE, originY + y * Tile::SIZE);
         }
     }
+    renderStats.tiles += std::max(0, endX - startX) * std::max(0, endY - startY);
+}
+
+// Last resort: one copy per visible tile
+void Map::renderTiles(SDL_Renderer* renderer, SDL_Rect& camera, int chunkX, int chunkY, const Chunk& chunk) {
+    int startX, endX, startY, endY;
+    visibleTiles(camera, chunkX, chunkY, startX, endX, startY, endY);
+    int originX = chunkX * ChunkTextureCache::PIXELS;
+    int originY = chunkY * ChunkTextureCache::PIXELS;
+    for (int y = startY; y < endY; ++y) {
+        for (int x = startX; x < endX; ++x) {
+            Tile::render(renderer, chunk.getTile(x, y), originX + x * Tile::SIZE, originY + y * Tile::SIZE, camera);
+        }
+    }
+    int copies = std::max(0, endX - startX) * std::max(0, endY - startY);
+    renderStats.drawCalls += copies;
+    renderStats.vertices += 4 * copies;
+    renderStats.tiles += copies;
+}
+
+void Map::countPrefetchHits(int startX, int endX, int startY, int endY) {
+    for (int chunkY = startY; chunkY < endY; ++chunkY) {
+        for (int chunkX = startX; chunkX < endX; ++chunkX) {
+            bool wasVisible = chunkX >= viewStartX && chunkX < viewEndX && chunkY >= viewStartY && chunkY < viewEndY;
+            if (wasVisible) continue;
+            if (chunks.find(chunkX, chunkY)) {
+                ++prefetchStats.hits;
+            } else {
+                ++prefetchStats.misses;
+            }
+        }
+    }
+    viewStartX = startX;
+    viewEndX = endX;
+    viewStartY = startY;
+    viewEndY = endY;
+}
+
+// Chunks that are still being generated are drawn as a flat block instead of stalling the frame
+void Map::renderPlaceholder(SDL_Renderer* renderer, SDL_Rect& camera, int chunkX, int chunkY) {
+    Uint8 r, g, b, a;
+    SDL_GetRenderDrawColor(renderer, &r, &g, &b, &a);
+
+    SDL_Rect placeholder = {chunkX * Chunk::SIZE * Tile::SIZE - camera.x, chunkY * Chunk::SIZE * Tile::SIZE - camera.y,
+                            Chunk::SIZE * Tile::SIZE, Chunk::SIZE * Tile::SIZE};
+    SDL_SetRenderDrawColor(renderer, 60, 60, 60, 255);
+    SDL_RenderFillRect(renderer, &placeholder);
+    ++renderStats.drawCalls;
+    renderStats.vertices += 4;
+
+    SDL_SetRenderDrawColor(renderer, r, g, b, a);
+}
+
+void Map::removeOutOfViewChunks(int visibleStartX, int visibleEndX, int visibleStartY, int visibleEndY) {
+    // Hysteresis: only chunks past the margin leave the active set, so walking
+    // back and forth over a chunk boundary never evicts anything
+    int startX = visibleStartX - evictionMargin;
+    int endX = visibleEndX + evictionMargin;
+    int startY = visibleStartY - evictionMargin;
+    int endY = visibleEndY + evictionMargin;
+    chunks.slideTo(startX, endX, startY, endY, &cache);
+    workers.cancelOutside(startX, endX, startY, endY);
+}
+
+void Map::setStreamingVelocity(float velocityX, float velocityY) {
+    this->velocityX = velocityX;
+    this->velocityY = velocityY;
+}
+
+void Map::setPrefetchHorizon(float seconds) {
+    prefetchHorizon = std::max(0.0f, seconds);
+}
+
+Map::PrefetchStats Map::getPrefetchStats() const {
+    return prefetchStats;
+}
+
+void Map::setChunkTextureBudget(size_t budgetBytes) {
+    textures.setBudget(budgetBytes);
+}
+
+ChunkTextureCache::Stats Map::getChunkTextureStats() const {
+    return textures.getStats();
+}
+
+ScrollBuffer::Stats Map::getScrollBufferStats() const {
+    return scroll.getStats();
+}
+
+void Map::invalidateChunkTextures() {
+    textures.invalidateAll();
+    scroll.invalidateAll();
+}
+
+void Map::freeChunkTextures() {
+    textures.clear();
+    scroll.clear();
+}
+
+void Map::setEvictionMargin(int margin) {
+    evictionMargin = std::max(0, margin);
+}
+
+void Map::setChunkCacheBudget(size_t budgetBytes) {
+    cache.setBudget(budgetBytes);
+}
+
+ChunkCache::Stats Map::getChunkCacheStats() const {
+    return cache.getStats();
+}
+
+RegionStore::Stats Map::getRegionStoreStats() const {
+    return regions.getStats();
 }
 
 bool Map::isChunkGenerated(int chunkX, int chunkY) const {
-    auto chunkIt = chunks.find(std::make_pair(chunkX, chunkY));
-    return chunkIt != chunks.end();
+    return chunks.find(chunkX, chunkY) != nullptr;
+}
+
+int Map::getLoadedChunkCount() const {
+    return chunks.getLoadedCount();
+}
+
+ChunkPool::Stats Map::getChunkPoolStats() const {
+    return pool.getStats();
+}
+
+long long Map::getGeneratedChunkCount() const {
+    return workers.getGeneratedCount();
+}
+
+void Map::setPersistence(bool enabled) {
+    workers.setRegionStore(enabled ? &regions : nullptr);
 }
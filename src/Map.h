@@ -2,27 +2,102 @@
 #define MAP_H
 
 #include "Tile.h"
-#include "../dep/FastNoiseLite.h"
+#include "Chunk.h"
+#include "ChunkGrid.h"
+#include "ChunkGenerator.h"
+#include "ChunkPool.h"
+#include "ChunkCache.h"
+#include "RegionStore.h"
+#include "ChunkWorkerPool.h"
+#include "ChunkTextureCache.h"
+#include "TileBatch.h"
+#include "ScrollBuffer.h"
 #include <vector>
-#include <map>
-#include <utility>
 #include <string>
 #include <SDL.h> // Include SDL for rendering
 
-class Chunk {
-public:
-    std::vector<std::vector<Tile>> tiles;
-};
-
 class Map {
 public:
-    Map(unsigned int seed);
+    // Chunks counted once each as they scroll into view
+    struct PrefetchStats {
+        long long hits;   // Already loaded when they became visible
+        long long misses; // Drawn as placeholders when they became visible
+    };
+
+    // How loaded chunks are drawn. Each mode falls back to the next one
+    // (scroll buffer -> textures -> geometry -> copies) when the renderer cannot do it
+    enum RenderMode {
+        RENDER_SCROLL_BUFFER,  // Wrap-around screen texture; only newly exposed tiles are drawn
+        RENDER_CHUNK_TEXTURES, // One quad per chunk from a pre-rendered texture
+        RENDER_TILE_GEOMETRY,  // All visible tiles in one SDL_RenderGeometry call
+        RENDER_TILE_COPIES     // One SDL_RenderCopy per tile
+    };
+
+    // Work submitted to the renderer by the last render() call
+    struct RenderStats {
+        int drawCalls;
+        int vertices; // Four per copied or filled rect, plus the tile batch's
+        int tiles;    // Tiles rasterized, onscreen or into a texture
+    };
+
+    // `streamingWorkers` of 0 generates chunks on the main thread, inside the streaming budget
+    Map(unsigned int seed, int streamingWorkers = ChunkWorkerPool::AUTO_WORKERS);
+    Map(const Map&) = delete;
+    Map& operator=(const Map&) = delete;
+    void reset(unsigned int newSeed);
     void generateChunk(int chunkX, int chunkY, unsigned int seed);
     void render(SDL_Renderer* renderer, SDL_Rect& camera);
+    void setRenderMode(RenderMode mode);
+    RenderMode getRenderMode() const { return renderMode; }
+    RenderStats getRenderStats() const { return renderStats; }
     void removeOutOfViewChunks(int visibleStartX, int visibleEndX, int visibleStartY, int visibleEndY);
     bool isChunkGenerated(int chunkX, int chunkY) const;
+    int getLoadedChunkCount() const;
+    ChunkPool::Stats getChunkPoolStats() const;
+    // Chunks the workers generated rather than read from disk
+    long long getGeneratedChunkCount() const;
+    // Whether streamed chunks are read from and saved to disk (on by default);
+    // while off, nothing under saves/ is created or pruned
+    void setPersistence(bool enabled);
+
+    // Chunks stay loaded until they are `margin` chunks beyond the visible
+    // window, then drop into an LRU cache limited to `budgetBytes`
+    void setEvictionMargin(int margin);
+    void setChunkCacheBudget(size_t budgetBytes);
+    ChunkCache::Stats getChunkCacheStats() const;
+    RegionStore::Stats getRegionStoreStats() const;
     std::string getBiomeAt(int x, int y);
     TileType getTileAt(int x, int y);
+    // Changes a loaded tile; returns false if its chunk is not loaded
+    bool setTileAt(int x, int y, TileType type);
+
+    // Loaded chunks are drawn from pre-rendered textures kept within
+    // `budgetBytes`; chunks that do not fit are drawn tile by tile
+    void setChunkTextureBudget(size_t budgetBytes);
+    ChunkTextureCache::Stats getChunkTextureStats() const;
+    ScrollBuffer::Stats getScrollBufferStats() const;
+    // After SDL_RENDER_TARGETS_RESET the texture contents are gone; this
+    // covers the scroll buffer too
+    void invalidateChunkTextures();
+    // Must be called before the renderer is destroyed
+    void freeChunkTextures();
+
+    // Background streaming: queue chunks, then pick up whatever finished
+    void requestChunk(int chunkX, int chunkY);
+    void setStreamingFocus(int chunkX, int chunkY);
+    int integrateGeneratedChunks();
+    // One frame of streaming for the inclusive visible window: slides the
+    // ring, queues missing chunks, then integrates (or, without workers,
+    // generates) chunks one at a time until `budgetMicros` is spent. At least
+    // one chunk is handled per call; the rest carries over to the next frame.
+    // Returns the number of units done
+    int streamChunks(int visibleStartX, int visibleEndX, int visibleStartY, int visibleEndY,
+                     int focusX, int focusY, Uint32 budgetMicros);
+    // Prefetch: the focus's velocity (pixels per second) is projected
+    // `seconds` ahead, and chunks along that path are streamed in early
+    void setStreamingVelocity(float velocityX, float velocityY);
+    void setPrefetchHorizon(float seconds);
+    PrefetchStats getPrefetchStats() const;
 
     static const int numberOfChunksWidth; // Define these based on your map's size
     static const int numberOfChunksHeight;
@@ -30,17 +105,33 @@ public:
     void loadTileProperties();
 
 private:
-    TileType generateGrasslandTile(float noiseValue, float riverNoiseValue, float biomeValue, int x, int y);
-    TileType generateSnowTile(float noiseValue, float biomeValue, int x, int y);
-
-    bool checkAdjacentToWater(int x, int y, const std::vector<std::vector<TileType>>& tempTypes);
+    void renderPlaceholder(SDL_Renderer* renderer, SDL_Rect& camera, int chunkX, int chunkY);
+    void renderTiles(SDL_Renderer* renderer, SDL_Rect& camera, int chunkX, int chunkY, const Chunk& chunk);
+    void batchTiles(SDL_Rect& camera, int chunkX, int chunkY, const Chunk& chunk);
+    static void visibleTiles(const SDL_Rect& camera, int chunkX, int chunkY, int& startX, int& endX, int& startY, int& endY);
+    void install(int chunkX, int chunkY, Chunk& chunk);
+    bool integrateNextChunk(int& integrated);
+    void countPrefetchHits(int startX, int endX, int startY, int endY);
 
     unsigned int seed;
-    int chunkSize;
-    std::map<std::pair<int, int>, Chunk> chunks;
-    float grasslandThreshold;
-    float snowThreshold;
-    FastNoiseLite noise, biomeNoise, riverNoise;
+    ChunkGrid chunks; // Ring of chunk slots that slides with the camera
+    ChunkGenerator generator; // Used for synchronous generation on the calling thread
+    ChunkCache cache; // Recently evicted chunks
+    ChunkTextureCache textures; // Pre-rendered images of loaded chunks
+    ScrollBuffer scroll; // Background for RENDER_SCROLL_BUFFER
+    TileBatch batch;
+    RenderMode renderMode;
+    RenderStats renderStats;
+    int evictionMargin;
+    float prefetchHorizon;
+    float velocityX, velocityY;
+    PrefetchStats prefetchStats;
+    int viewStartX, viewEndX, viewStartY, viewEndY; // Chunks rendered last frame, end exclusive
+    ChunkPool pool; // Must outlive the workers, which return buffers to it
+    RegionStore regions; // On-disk copies of generated chunks, used by the workers
+    ChunkWorkerPool workers;
+    std::vector<ChunkWorkerPool::Result> generatedChunks; // Reused hand-off buffer
+    size_t nextGenerated; // Results before this index are already integrated
 };
 
 #endif
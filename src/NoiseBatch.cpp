@@ -0,0 +1,381 @@
+#include "NoiseBatch.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define NOISEBATCH_X86 1
+#include <emmintrin.h>
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define NOISEBATCH_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define NOISEBATCH_TARGET_AVX2
+#endif
+
+namespace {
+
+// Same constants and gradient table as FastNoiseLite's 2D Perlin path
+const int PrimeX = 501125321;
+const int PrimeY = 1136930381;
+const int HashMultiplier = 0x27d4eb2d;
+const float PerlinScale = 1.4247691104677813f;
+
+const float Gradients2D[256] = {
+    0.130526192220052f, 0.99144486137381f, 0.38268343236509f, 0.923879532511287f, 0.608761429008721f, 0.793353340291235f, 0.793353340291235f, 0.608761429008721f,
+    0.923879532511287f, 0.38268343236509f, 0.99144486137381f, 0.130526192220051f, 0.99144486137381f, -0.130526192220051f, 0.923879532511287f, -0.38268343236509f,
+    0.793353340291235f, -0.60876142900872f, 0.608761429008721f, -0.793353340291235f, 0.38268343236509f, -0.923879532511287f, 0.130526192220052f, -0.99144486137381f,
+    -0.130526192220052f, -0.99144486137381f, -0.38268343236509f, -0.923879532511287f, -0.608761429008721f, -0.793353340291235f, -0.793353340291235f, -0.608761429008721f,
+    -0.923879532511287f, -0.38268343236509f, -0.99144486137381f, -0.130526192220052f, -0.99144486137381f, 0.130526192220051f, -0.923879532511287f, 0.38268343236509f,
+    -0.793353340291235f, 0.608761429008721f, -0.608761429008721f, 0.793353340291235f, -0.38268343236509f, 0.923879532511287f, -0.130526192220052f, 0.99144486137381f,
+    0.130526192220052f, 0.99144486137381f, 0.38268343236509f, 0.923879532511287f, 0.608761429008721f, 0.793353340291235f, 0.793353340291235f, 0.608761429008721f,
+    0.923879532511287f, 0.38268343236509f, 0.99144486137381f, 0.130526192220051f, 0.99144486137381f, -0.130526192220051f, 0.923879532511287f, -0.38268343236509f,
+    0.793353340291235f, -0.60876142900872f, 0.608761429008721f, -0.793353340291235f, 0.38268343236509f, -0.923879532511287f, 0.130526192220052f, -0.99144486137381f,
+    -0.130526192220052f, -0.99144486137381f, -0.38268343236509f, -0.923879532511287f, -0.608761429008721f, -0.793353340291235f, -0.793353340291235f, -0.608761429008721f,
+    -0.923879532511287f, -0.38268343236509f, -0.99144486137381f, -0.130526192220052f, -0.99144486137381f, 0.130526192220051f, -0.923879532511287f, 0.38268343236509f,
+    -0.793353340291235f, 0.608761429008721f, -0.608761429008721f, 0.793353340291235f, -0.38268343236509f, 0.923879532511287f, -0.130526192220052f, 0.99144486137381f,
+    0.130526192220052f, 0.99144486137381f, 0.38268343236509f, 0.923879532511287f, 0.608761429008721f, 0.793353340291235f, 0.793353340291235f, 0.608761429008721f,
+    0.923879532511287f, 0.38268343236509f, 0.99144486137381f, 0.130526192220051f, 0.99144486137381f, -0.130526192220051f, 0.923879532511287f, -0.38268343236509f,
+    0.793353340291235f, -0.60876142900872f, 0.608761429008721f, -0.793353340291235f, 0.38268343236509f, -0.923879532511287f, 0.130526192220052f, -0.99144486137381f,
+    -0.130526192220052f, -0.99144486137381f, -0.38268343236509f, -0.923879532511287f, -0.608761429008721f, -0.793353340291235f, -0.793353340291235f, -0.608761429008721f,
+    -0.923879532511287f, -0.38268343236509f, -0.99144486137381f, -0.130526192220052f, -0.99144486137381f, 0.130526192220051f, -0.923879532511287f, 0.38268343236509f,
+    -0.793353340291235f, 0.608761429008721f, -0.608761429008721f, 0.793353340291235f, -0.38268343236509f, 0.923879532511287f, -0.130526192220052f, 0.99144486137381f,
+    0.130526192220052f, 0.99144486137381f, 0.38268343236509f, 0.923879532511287f, 0.608761429008721f, 0.793353340291235f, 0.793353340291235f, 0.608761429008721f,
+    0.923879532511287f, 0.38268343236509f, 0.99144486137381f, 0.130526192220051f, 0.99144486137381f, -0.130526192220051f, 0.923879532511287f, -0.38268343236509f,
+    0.793353340291235f, -0.60876142900872f, 0.608761429008721f, -0.793353340291235f, 0.38268343236509f, -0.923879532511287f, 0.130526192220052f, -0.99144486137381f,
+    -0.130526192220052f, -0.99144486137381f, -0.38268343236509f, -0.923879532511287f, -0.608761429008721f, -0.793353340291235f, -0.793353340291235f, -0.608761429008721f,
+    -0.923879532511287f, -0.38268343236509f, -0.99144486137381f, -0.130526192220052f, -0.99144486137381f, 0.130526192220051f, -0.923879532511287f, 0.38268343236509f,
+    -0.793353340291235f, 0.608761429008721f, -0.608761429008721f, 0.793353340291235f, -0.38268343236509f, 0.923879532511287f, -0.130526192220052f, 0.99144486137381f,
+    0.130526192220052f, 0.99144486137381f, 0.38268343236509f, 0.923879532511287f, 0.608761429008721f, 0.793353340291235f, 0.793353340291235f, 0.608761429008721f,
+    0.923879532511287f, 0.38268343236509f, 0.99144486137381f, 0.130526192220051f, 0.99144486137381f, -0.130526192220051f, 0.923879532511287f, -0.38268343236509f,
+    0.793353340291235f, -0.60876142900872f, 0.608761429008721f, -0.793353340291235f, 0.38268343236509f, -0.923879532511287f, 0.130526192220052f, -0.99144486137381f,
+    -0.130526192220052f, -0.99144486137381f, -0.38268343236509f, -0.923879532511287f, -0.608761429008721f, -0.793353340291235f, -0.793353340291235f, -0.608761429008721f,
+    -0.923879532511287f, -0.38268343236509f, -0.99144486137381f, -0.130526192220052f, -0.99144486137381f, 0.130526192220051f, -0.923879532511287f, 0.38268343236509f,
+    -0.793353340291235f, 0.608761429008721f, -0.608761429008721f, 0.793353340291235f, -0.38268343236509f, 0.923879532511287f, -0.130526192220052f, 0.99144486137381f,
+    0.38268343236509f, 0.923879532511287f, 0.923879532511287f, 0.38268343236509f, 0.923879532511287f, -0.38268343236509f, 0.38268343236509f, -0.923879532511287f,
+    -0.38268343236509f, -0.923879532511287f, -0.923879532511287f, -0.38268343236509f, -0.923879532511287f, 0.38268343236509f, -0.38268343236509f, 0.923879532511287f,
+};
+
+inline int fastFloor(float f) { return f >= 0 ? (int)f : (int)f - 1; }
+
+inline float interpQuintic(float t) { return t * t * t * (t * (t * 6 - 15) + 10); }
+
+inline float lerp(float a, float b, float t) { return a + t * (b - a); }
+
+// Signed overflow is part of the hash, so multiply as unsigned to keep it defined
+inline int wrapMul(int a, int b) { return (int)((unsigned int)a * (unsigned int)b); }
+inline int wrapAdd(int a, int b) { return (int)((unsigned int)a + (unsigned int)b); }
+
+inline float gradCoord(int seed, int xPrimed, int yPrimed, float xd, float yd) {
+    int hash = wrapMul(seed ^ xPrimed ^ yPrimed, HashMultiplier);
+    hash ^= hash >> 15;
+    hash &= 127 << 1;
+    return xd * Gradients2D[hash] + yd * Gradients2D[hash | 1];
+}
+
+// Per-row values shared by every lane of that row
+struct RowSetup {
+    float yd0, yd1, ys;
+    int y0, y1;
+};
+
+inline RowSetup setupRow(const NoiseChannel& channel, int y) {
+    float fy = (float)y * channel.frequency;
+    int y0 = fastFloor(fy);
+    RowSetup row;
+    row.yd0 = fy - (float)y0;
+    row.yd1 = row.yd0 - 1;
+    row.ys = interpQuintic(row.yd0);
+    row.y0 = wrapMul(y0, PrimeY);
+    row.y1 = wrapAdd(row.y0, PrimeY);
+    return row;
+}
+
+inline float perlinPoint(const NoiseChannel& channel, const RowSetup& row, int x) {
+    float fx = (float)x * channel.frequency;
+    int x0 = fastFloor(fx);
+    float xd0 = fx - (float)x0;
+    float xd1 = xd0 - 1;
+    float xs = interpQuintic(xd0);
+    x0 = wrapMul(x0, PrimeX);
+    int x1 = wrapAdd(x0, PrimeX);
+
+    float xf0 = lerp(gradCoord(channel.seed, x0, row.y0, xd0, row.yd0), gradCoord(channel.seed, x1, row.y0, xd1, row.yd0), xs);
+    float xf1 = lerp(gradCoord(channel.seed, x0, row.y1, xd0, row.yd1), gradCoord(channel.seed, x1, row.y1, xd1, row.yd1), xs);
+    return lerp(xf0, xf1, row.ys) * PerlinScale;
+}
+
+// Rows of several channels over the same x range; `rows[c]` and `out[c]`
+// belong to channels[c]. N is fixed at compile time so the channel loops unroll
+typedef void (*RowsFunction)(const NoiseChannel* channels, const RowSetup* rows, int x, int count, float* const* out);
+
+template <int N>
+void perlinRowsScalar(const NoiseChannel* channels, const RowSetup* rows, int x, int count, float* const* out) {
+    for (int i = 0; i < count; ++i) {
+        for (int c = 0; c < N; ++c) {
+            out[c][i] = perlinPoint(channels[c], rows[c], x + i);
+        }
+    }
+}
+
+#ifdef NOISEBATCH_X86
+
+// SSE2 has no 32-bit low multiply, so build it from two 32x32->64 multiplies
+inline __m128i mulloSse2(__m128i a, __m128i b) {
+    __m128i even = _mm_mul_epu32(a, b);
+    __m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+    return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+                              _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+}
+
+inline __m128 quinticSse2(__m128 t) {
+    __m128 t3 = _mm_mul_ps(_mm_mul_ps(t, t), t);
+    __m128 inner = _mm_sub_ps(_mm_mul_ps(t, _mm_set1_ps(6)), _mm_set1_ps(15));
+    inner = _mm_add_ps(_mm_mul_ps(t, inner), _mm_set1_ps(10));
+    return _mm_mul_ps(t3, inner);
+}
+
+inline __m128 lerpSse2(__m128 a, __m128 b, __m128 t) {
+    return _mm_add_ps(a, _mm_mul_ps(t, _mm_sub_ps(b, a)));
+}
+
+inline __m128 gradSse2(__m128i seed, __m128i xPrimed, __m128i yPrimed, __m128 xd, __m128 yd) {
+    __m128i hash = mulloSse2(_mm_xor_si128(_mm_xor_si128(seed, xPrimed), yPrimed), _mm_set1_epi32(HashMultiplier));
+    hash = _mm_xor_si128(hash, _mm_srai_epi32(hash, 15));
+    hash = _mm_and_si128(hash, _mm_set1_epi32(127 << 1));
+
+    // No gather before AVX2; four scalar loads are still cheaper than the hash
+    alignas(16) int index[4];
+    _mm_store_si128(reinterpret_cast<__m128i*>(index), hash);
+    __m128 xg = _mm_setr_ps(Gradients2D[index[0]], Gradients2D[index[1]], Gradients2D[index[2]], Gradients2D[index[3]]);
+    __m128 yg = _mm_setr_ps(Gradients2D[index[0] | 1], Gradients2D[index[1] | 1], Gradients2D[index[2] | 1], Gradients2D[index[3] | 1]);
+    return _mm_add_ps(_mm_mul_ps(xd, xg), _mm_mul_ps(yd, yg));
+}
+
+// One channel's row values broadcast to every lane
+struct LanesSse2 {
+    __m128i seed, y0, y1;
+    __m128 frequency, yd0, yd1, ys;
+};
+
+inline void broadcastSse2(const NoiseChannel& channel, const RowSetup& row, LanesSse2& lanes) {
+    lanes.seed = _mm_set1_epi32(channel.seed);
+    lanes.frequency = _mm_set1_ps(channel.frequency);
+    lanes.y0 = _mm_set1_epi32(row.y0);
+    lanes.y1 = _mm_set1_epi32(row.y1);
+    lanes.yd0 = _mm_set1_ps(row.yd0);
+    lanes.yd1 = _mm_set1_ps(row.yd1);
+    lanes.ys = _mm_set1_ps(row.ys);
+}
+
+// Noise at four consecutive x, given as floats
+inline __m128 perlinSse2(const LanesSse2& lanes, __m128 x) {
+    __m128 fx = _mm_mul_ps(x, lanes.frequency);
+    // FastFloor: truncate, then subtract one for negative inputs (even integral ones)
+    __m128i x0 = _mm_add_epi32(_mm_cvttps_epi32(fx), _mm_castps_si128(_mm_cmplt_ps(fx, _mm_setzero_ps())));
+    __m128 xd0 = _mm_sub_ps(fx, _mm_cvtepi32_ps(x0));
+    __m128 xd1 = _mm_sub_ps(xd0, _mm_set1_ps(1));
+    __m128 xs = quinticSse2(xd0);
+    x0 = mulloSse2(x0, _mm_set1_epi32(PrimeX));
+    __m128i x1 = _mm_add_epi32(x0, _mm_set1_epi32(PrimeX));
+
+    __m128 xf0 = lerpSse2(gradSse2(lanes.seed, x0, lanes.y0, xd0, lanes.yd0), gradSse2(lanes.seed, x1, lanes.y0, xd1, lanes.yd0), xs);
+    __m128 xf1 = lerpSse2(gradSse2(lanes.seed, x0, lanes.y1, xd0, lanes.yd1), gradSse2(lanes.seed, x1, lanes.y1, xd1, lanes.yd1), xs);
+    return _mm_mul_ps(lerpSse2(xf0, xf1, lanes.ys), _mm_set1_ps(PerlinScale));
+}
+
+template <int N>
+void perlinRowsSse2(const NoiseChannel* channels, const RowSetup* rows, int x, int count, float* const* out) {
+    LanesSse2 lanes[N];
+    for (int c = 0; c < N; ++c) {
+        broadcastSse2(channels[c], rows[c], lanes[c]);
+    }
+    __m128i lane = _mm_setr_epi32(x, x + 1, x + 2, x + 3);
+
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        // The lane coordinates are shared by every channel
+        __m128 laneX = _mm_cvtepi32_ps(lane);
+        for (int c = 0; c < N; ++c) {
+            _mm_storeu_ps(out[c] + i, perlinSse2(lanes[c], laneX));
+        }
+        lane = _mm_add_epi32(lane, _mm_set1_epi32(4));
+    }
+
+    float* tail[N];
+    for (int c = 0; c < N; ++c) {
+        tail[c] = out[c] + i;
+    }
+    perlinRowsScalar<N>(channels, rows, x + i, count - i, tail);
+}
+
+NOISEBATCH_TARGET_AVX2 inline __m256 quinticAvx2(__m256 t) {
+    __m256 t3 = _mm256_mul_ps(_mm256_mul_ps(t, t), t);
+    __m256 inner = _mm256_sub_ps(_mm256_mul_ps(t, _mm256_set1_ps(6)), _mm256_set1_ps(15));
+    inner = _mm256_add_ps(_mm256_mul_ps(t, inner), _mm256_set1_ps(10));
+    return _mm256_mul_ps(t3, inner);
+}
+
+NOISEBATCH_TARGET_AVX2 inline __m256 lerpAvx2(__m256 a, __m256 b, __m256 t) {
+    return _mm256_add_ps(a, _mm256_mul_ps(t, _mm256_sub_ps(b, a)));
+}
+
+NOISEBATCH_TARGET_AVX2 inline __m256 gradAvx2(__m256i seed, __m256i xPrimed, __m256i yPrimed, __m256 xd, __m256 yd) {
+    __m256i hash = _mm256_mullo_epi32(_mm256_xor_si256(_mm256_xor_si256(seed, xPrimed), yPrimed), _mm256_set1_epi32(HashMultiplier));
+    hash = _mm256_xor_si256(hash, _mm256_srai_epi32(hash, 15));
+    hash = _mm256_and_si256(hash, _mm256_set1_epi32(127 << 1));
+
+    __m256 xg = _mm256_i32gather_ps(Gradients2D, hash, 4);
+    __m256 yg = _mm256_i32gather_ps(Gradients2D, _mm256_or_si256(hash, _mm256_set1_epi32(1)), 4);
+    return _mm256_add_ps(_mm256_mul_ps(xd, xg), _mm256_mul_ps(yd, yg));
+}
+
+struct LanesAvx2 {
+    __m256i seed, y0, y1;
+    __m256 frequency, yd0, yd1, ys;
+};
+
+NOISEBATCH_TARGET_AVX2 inline void broadcastAvx2(const NoiseChannel& channel, const RowSetup& row, LanesAvx2& lanes) {
+    lanes.seed = _mm256_set1_epi32(channel.seed);
+    lanes.frequency = _mm256_set1_ps(channel.frequency);
+    lanes.y0 = _mm256_set1_epi32(row.y0);
+    lanes.y1 = _mm256_set1_epi32(row.y1);
+    lanes.yd0 = _mm256_set1_ps(row.yd0);
+    lanes.yd1 = _mm256_set1_ps(row.yd1);
+    lanes.ys = _mm256_set1_ps(row.ys);
+}
+
+NOISEBATCH_TARGET_AVX2 inline __m256 perlinAvx2(const LanesAvx2& lanes, __m256 x) {
+    __m256 fx = _mm256_mul_ps(x, lanes.frequency);
+    __m256i x0 = _mm256_add_epi32(_mm256_cvttps_epi32(fx), _mm256_castps_si256(_mm256_cmp_ps(fx, _mm256_setzero_ps(), _CMP_LT_OQ)));
+    __m256 xd0 = _mm256_sub_ps(fx, _mm256_cvtepi32_ps(x0));
+    __m256 xd1 = _mm256_sub_ps(xd0, _mm256_set1_ps(1));
+    __m256 xs = quinticAvx2(xd0);
+    x0 = _mm256_mullo_epi32(x0, _mm256_set1_epi32(PrimeX));
+    __m256i x1 = _mm256_add_epi32(x0, _mm256_set1_epi32(PrimeX));
+
+    __m256 xf0 = lerpAvx2(gradAvx2(lanes.seed, x0, lanes.y0, xd0, lanes.yd0), gradAvx2(lanes.seed, x1, lanes.y0, xd1, lanes.yd0), xs);
+    __m256 xf1 = lerpAvx2(gradAvx2(lanes.seed, x0, lanes.y1, xd0, lanes.yd1), gradAvx2(lanes.seed, x1, lanes.y1, xd1, lanes.yd1), xs);
+    return _mm256_mul_ps(lerpAvx2(xf0, xf1, lanes.ys), _mm256_set1_ps(PerlinScale));
+}
+
+template <int N>
+NOISEBATCH_TARGET_AVX2 void perlinRowsAvx2(const NoiseChannel* channels, const RowSetup* rows, int x, int count, float* const* out) {
+    LanesAvx2 lanes[N];
+    for (int c = 0; c < N; ++c) {
+        broadcastAvx2(channels[c], rows[c], lanes[c]);
+    }
+    __m256i lane = _mm256_setr_epi32(x, x + 1, x + 2, x + 3, x + 4, x + 5, x + 6, x + 7);
+
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256 laneX = _mm256_cvtepi32_ps(lane);
+        for (int c = 0; c < N; ++c) {
+            _mm256_storeu_ps(out[c] + i, perlinAvx2(lanes[c], laneX));
+        }
+        lane = _mm256_add_epi32(lane, _mm256_set1_epi32(8));
+    }
+
+    float* tail[N];
+    for (int c = 0; c < N; ++c) {
+        tail[c] = out[c] + i;
+    }
+    perlinRowsSse2<N>(channels, rows, x + i, count - i, tail);
+}
+
+bool cpuHasAvx2() {
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) return false;
+    __cpuid(info, 1);
+    bool osSavesYmm = (info[2] & (1 << 27)) && (info[2] & (1 << 28)) && ((_xgetbv(0) & 6) == 6);
+    __cpuidex(info, 7, 0);
+    return osSavesYmm && (info[1] & (1 << 5));
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+#endif // NOISEBATCH_X86
+
+}
+
+NoiseBatch::Backend NoiseBatch::backend = NoiseBatch::detectBackend();
+
+NoiseBatch::Backend NoiseBatch::detectBackend() {
+#ifdef NOISEBATCH_X86
+    return cpuHasAvx2() ? AVX2 : SSE2;
+#else
+    return SCALAR;
+#endif
+}
+
+NoiseBatch::Backend NoiseBatch::getBackend() {
+    return backend;
+}
+
+void NoiseBatch::setBackend(Backend requested) {
+    Backend best = detectBackend();
+    backend = requested > best ? best : requested;
+}
+
+const char* NoiseBatch::getBackendName(Backend backend) {
+    switch (backend) {
+        case SSE2: return "sse2";
+        case AVX2: return "avx2";
+        default: return "scalar";
+    }
+}
+
+namespace {
+
+template <int N>
+RowsFunction selectRows(NoiseBatch::Backend backend) {
+    switch (backend) {
+#ifdef NOISEBATCH_X86
+        case NoiseBatch::AVX2: return &perlinRowsAvx2<N>;
+        case NoiseBatch::SSE2: return &perlinRowsSse2<N>;
+#endif
+        default: return &perlinRowsScalar<N>;
+    }
+}
+
+template <int N>
+void perlinGridsFused(const NoiseChannel* channels, int originX, int originY, int width, int height, float* const* outs, NoiseBatch::Backend backend) {
+    // Backend and channel count are resolved once per grid, not per row or point
+    RowsFunction rowsFunction = selectRows<N>(backend);
+    RowSetup rows[N];
+    float* out[N];
+    for (int j = 0; j < height; ++j) {
+        for (int c = 0; c < N; ++c) {
+            rows[c] = setupRow(channels[c], originY + j);
+            out[c] = outs[c] + j * width;
+        }
+        rowsFunction(channels, rows, originX, width, out);
+    }
+}
+
+}
+
+void NoiseBatch::perlinGrid(const NoiseChannel& channel, int originX, int originY, int width, int height, float* out) {
+    perlinGridsFused<1>(&channel, originX, originY, width, height, &out, backend);
+}
+
+void NoiseBatch::perlinGrids(const NoiseChannel* channels, int count, int originX, int originY, int width, int height, float* const* outs) {
+    while (count > 0) {
+        int fused = count < MAX_FUSED ? count : MAX_FUSED;
+        switch (fused) {
+            case 1: perlinGridsFused<1>(channels, originX, originY, width, height, outs, backend); break;
+            case 2: perlinGridsFused<2>(channels, originX, originY, width, height, outs, backend); break;
+            case 3: perlinGridsFused<3>(channels, originX, originY, width, height, outs, backend); break;
+            default: perlinGridsFused<4>(channels, originX, originY, width, height, outs, backend); break;
+        }
+        channels += fused;
+        outs += fused;
+        count -= fused;
+    }
+}
@@ -0,0 +1,38 @@
+#ifndef NOISEBATCH_H
+#define NOISEBATCH_H
+
+// Settings of one FastNoiseLite Perlin field (no fractal, no rotation)
+struct NoiseChannel {
+    int seed;
+    float frequency;
+};
+
+// Evaluates 2D Perlin noise over whole integer lattices at once, using SSE2 or
+// AVX2 when the CPU has them. Every backend reproduces FastNoiseLite's scalar
+// GetNoise(x, y) bit for bit, so existing seeds keep producing the same worlds.
+// The one caveat is FMA contraction: if this file or FastNoiseLite.h is built
+// with FMA enabled (e.g. -march=native with -ffp-contract=fast), the two sides
+// may round differently by up to ~1e-6, which is below any tile threshold.
+class NoiseBatch {
+public:
+    enum Backend { SCALAR, SSE2, AVX2 };
+    static const int MAX_FUSED = 4;
+
+    // out[j * width + i] = noise(originX + i, originY + j)
+    static void perlinGrid(const NoiseChannel& channel, int originX, int originY, int width, int height, float* out);
+    // Same as calling perlinGrid for each channel into outs[c], but up to
+    // MAX_FUSED channels are evaluated in one pass sharing the row and lane
+    // setup. Results are identical to the separate calls
+    static void perlinGrids(const NoiseChannel* channels, int count, int originX, int originY, int width, int height, float* const* outs);
+
+    static Backend getBackend();
+    // Forces a backend (clamped to what the CPU supports); for tests and benchmarks
+    static void setBackend(Backend backend);
+    static const char* getBackendName(Backend backend);
+
+private:
+    static Backend detectBackend();
+    static Backend backend;
+};
+
+#endif
@@ -1,21 +1,27 @@
 #include "Player.h"
+#include "TextureAtlas.h"
+#include "Profiler.h"
 #include <SDL_image.h>
+#include <cmath>
 #include <iostream>
 
 const float Player::BIOME_CHANGE_COOLDOWN = 1.0f;
 SDL_Texture* Player::playerTexture = nullptr;
-
-Player::Player(int x, int y) : x(x), y(y), speed(5), frameIndex(0), frameTime(0.0f), animationSpeed(0.1f) {
-    idleSrcRect = { 0, 0, 32, 32 };
-    walkingSrcRects[0][0] = { 32, 0, 32, 32 }; // Down
-    walkingSrcRects[0][1] = { 64, 0, 32, 32 }; // Down
-    walkingSrcRects[3][0] = { 96, 0, 32, 32 }; // Right
-    walkingSrcRects[3][1] = { 128, 0, 32, 32 }; // Right
-    walkingSrcRects[2][0] = { 160, 0, 32, 32 }; // Up
-    walkingSrcRects[2][1] = { 192, 0, 32, 32 }; // Up
-    walkingSrcRects[1][0] = { 224, 0, 32, 32 }; // Left
-    walkingSrcRects[1][1] = { 256, 0, 32, 32 }; // Left
-    destRect = { x, y, 32, 32 };
+bool Player::ownsTexture = false;
+
+// Layout of player_sprite_map.png; replaced by atlas rects in useAtlas()
+SDL_Rect Player::idleSrcRect = { 0, 0, 32, 32 };
+std::array<std::array<SDL_Rect, Player::numFrames>, Player::numDirections> Player::walkingSrcRects = {{
+    {{ { 32, 0, 32, 32 }, { 64, 0, 32, 32 } }},   // Down
+    {{ { 224, 0, 32, 32 }, { 256, 0, 32, 32 } }}, // Left
+    {{ { 160, 0, 32, 32 }, { 192, 0, 32, 32 } }}, // Up
+    {{ { 96, 0, 32, 32 }, { 128, 0, 32, 32 } }}   // Right
+}};
+const char* const Player::directionNames[Player::numDirections] = {"down", "left", "up", "right"};
+
+Player::Player(int x, int y) : x(x), y(y), prevX(x), prevY(y), speed(300.0f), velocityX(0.0f), velocityY(0.0f),
+    movingUp(false), movingDown(false), movingLeft(false), movingRight(false), frameIndex(0), frameTime(0.0f), animationSpeed(0.1f) {
+    srcRect = idleSrcRect;
 }
 
 void Player::updateAnimation(float deltaTime) {
@@ -62,11 +68,15 @@ void Player::update(float deltaTime) {
         moveY *= invLength;
     }
 
-    x += moveX * speed;
-    y += moveY * speed;
+    prevX = x;
+    prevY = y;
+    x += moveX * speed * deltaTime;
+    y += moveY * speed * deltaTime;
 
-    destRect.x = x;
-    destRect.y = y;
+    if (deltaTime > 0.0f) {
+        velocityX = (x - prevX) / deltaTime;
+        velocityY = (y - prevY) / deltaTime;
+    }
 
     // Update the animation based on movement
     updateAnimation(deltaTime);
@@ -106,13 +116,14 @@ void Player::handleInput(const SDL_Event& event) {
     }
 }
 
-void Player::render(SDL_Renderer* renderer, const SDL_Rect& camera) {
+void Player::render(SDL_Renderer* renderer, const SDL_Rect& camera, float alpha) {
+    PROFILE_ZONE(ZONE_PLAYER_RENDER);
     if (!playerTexture) {
         std::cerr << "Player texture not loaded." << std::endl;
         return;
     }
 
-    SDL_Rect renderQuad = {destRect.x - camera.x, destRect.y - camera.y, destRect.w, destRect.h};
+    SDL_Rect renderQuad = {getRenderX(alpha) - camera.x, getRenderY(alpha) - camera.y, 32, 32};
     
     // Render the player texture instead of a red square
     SDL_RenderCopy(renderer, playerTexture, &srcRect, &renderQuad);
@@ -126,14 +137,53 @@ void Player::loadPlayerTexture(SDL_Renderer* renderer, const char* filePath) {
         return;
     }
     // Assign the new texture to the playerTexture member
+    destroyTexture();
     playerTexture = newTexture;
+    ownsTexture = true;
 }
 
 void Player::destroyTexture() {
-    if (playerTexture != nullptr) {
+    if (playerTexture != nullptr && ownsTexture) {
         SDL_DestroyTexture(playerTexture);
-        playerTexture = nullptr;
     }
+    playerTexture = nullptr;
+    ownsTexture = false;
+}
+
+void Player::addToAtlas(TextureAtlas& atlas, const char* filePath) {
+    int source = atlas.addImage(filePath);
+    atlas.addRegion("player/idle", source, idleSrcRect);
+    for (int direction = 0; direction < numDirections; ++direction) {
+        for (int frame = 0; frame < numFrames; ++frame) {
+            atlas.addRegion(std::string("player/") + directionNames[direction] + "/" + std::to_string(frame),
+                            source, walkingSrcRects[direction][frame]);
+        }
+    }
+}
+
+bool Player::useAtlas(const TextureAtlas& atlas) {
+    const TextureAtlas::Region* idle = atlas.find("player/idle");
+    const TextureAtlas::Region* walking[numDirections][numFrames];
+    for (int direction = 0; direction < numDirections; ++direction) {
+        for (int frame = 0; frame < numFrames; ++frame) {
+            walking[direction][frame] = atlas.find(std::string("player/") + directionNames[direction] + "/" + std::to_string(frame));
+            // Frames are drawn from a single texture
+            if (!idle || !walking[direction][frame] || walking[direction][frame]->texture != idle->texture) {
+                std::cerr << "Player frames are missing from the atlas page" << std::endl;
+                return false;
+            }
+        }
+    }
+
+    destroyTexture();
+    playerTexture = idle->texture;
+    idleSrcRect = idle->rect;
+    for (int direction = 0; direction < numDirections; ++direction) {
+        for (int frame = 0; frame < numFrames; ++frame) {
+            walkingSrcRects[direction][frame] = walking[direction][frame]->rect;
+        }
+    }
+    return true;
 }
 
 void Player::setMovingUp(bool move) {
@@ -152,10 +202,37 @@ void Player::setMovingRight(bool move) {
     movingRight = move;
 }
 
+void Player::setWalkSpeed(float pixelsPerSecond) {
+    speed = pixelsPerSecond;
+}
+
+void Player::setPosition(int newX, int newY) {
+    x = prevX = static_cast<float>(newX);
+    y = prevY = static_cast<float>(newY);
+    velocityX = 0.0f;
+    velocityY = 0.0f;
+}
+
 int Player::getX() const {
-    return x; // Assuming 'x' is the variable holding the player's x-coordinate
+    return static_cast<int>(std::floor(x));
 }
 
 int Player::getY() const {
-    return y; // Assuming 'y' is the variable holding the player's y-coordinate
+    return static_cast<int>(std::floor(y));
+}
+
+int Player::getRenderX(float alpha) const {
+    return static_cast<int>(std::floor(prevX + (x - prevX) * alpha));
+}
+
+int Player::getRenderY(float alpha) const {
+    return static_cast<int>(std::floor(prevY + (y - prevY) * alpha));
+}
+
+float Player::getVelocityX() const {
+    return velocityX;
+}
+
+float Player::getVelocityY() const {
+    return velocityY;
 }
@@ -5,33 +5,52 @@
 #include <string>
 #include <array>
 
+class TextureAtlas;
+
 class Player {
 public:
     Player(int x, int y);
     int getX() const;
     int getY() const;
+    // Position drawn `alpha` of the way from the previous update to the latest
+    int getRenderX(float alpha) const;
+    int getRenderY(float alpha) const;
+    // Velocity over the last update, in pixels per second
+    float getVelocityX() const;
+    float getVelocityY() const;
     void update(float deltaTime);
-    void render(SDL_Renderer* renderer, const SDL_Rect& camera);
+    void render(SDL_Renderer* renderer, const SDL_Rect& camera, float alpha = 1.0f);
     void handleInput(const SDL_Event& event);
     static void loadPlayerTexture(SDL_Renderer* renderer, const char* filePath);
     static void destroyTexture();
+    // Queues the sprite sheet's frames as regions "player/idle" and
+    // "player/<direction>/<frame>"
+    static void addToAtlas(TextureAtlas& atlas, const char* filePath);
+    // Draws from the atlas from now on; fails, changing nothing, if a frame is missing
+    static bool useAtlas(const TextureAtlas& atlas);
 
     // Setters for movement states
     void setMovingUp(bool move);
     void setMovingDown(bool move);
     void setMovingLeft(bool move);
     void setMovingRight(bool move);
-     void setWalkSpeed(int newSpeed);
+    void setWalkSpeed(float pixelsPerSecond);
+    // Moves without interpolating from the old position
+    void setPosition(int newX, int newY);
 
 private:
-    int x, y, speed;
+    float x, y;
+    float prevX, prevY; // Position before the last update, for interpolation
+    float speed; // Pixels per second
+    float velocityX, velocityY;
     bool movingUp, movingDown, movingLeft, movingRight;
-    SDL_Rect srcRect, destRect;
+    SDL_Rect srcRect;
     std::string currentBiome; 
     std::string lastBiome;
     float timeSinceLastBiomeChange;
     static const float BIOME_CHANGE_COOLDOWN;
     static SDL_Texture* playerTexture;
+    static bool ownsTexture; // False when it is an atlas page
 
     // Animation related members
     int frameIndex; // Current frame in the animation
@@ -40,9 +59,10 @@ private:
     static const int numFrames = 2; // Number of frames per animation
     static const int numDirections = 4; // Number of directions (down, left, up, right)
 
-    // Arrays to hold the source rectangles for each animation frame
-    SDL_Rect idleSrcRect; // Source rectangle for idle frame
-    std::array<std::array<SDL_Rect, numFrames>, numDirections> walkingSrcRects; // Source rectangles for walking animations
+    // Source rectangles for each animation frame, in the sprite sheet or the atlas
+    static SDL_Rect idleSrcRect; // Source rectangle for idle frame
+    static std::array<std::array<SDL_Rect, numFrames>, numDirections> walkingSrcRects; // Source rectangles for walking animations
+    static const char* const directionNames[numDirections];
 
     // Helper function to update animation
     void updateAnimation(float deltaTime);
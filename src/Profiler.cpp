@@ -0,0 +1,174 @@
+#include "Profiler.h"
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+// A ring slot. `sequence` is 2 * index + 1 while event `index` is being
+// written and 2 * index + 2 once it is complete, so the reader can tell a
+// finished event from one still in progress or already overwritten
+struct ProfileEvent {
+    std::atomic<Uint64> sequence;
+    std::atomic<Uint64> start;
+    std::atomic<Uint64> end;
+    std::atomic<int> zone;
+};
+
+static ProfileEvent ring[Profiler::RING_SIZE];
+static std::atomic<Uint64> writeIndex(0);
+static Uint64 readIndex = 0;
+static long long droppedEvents = 0;
+
+static std::vector<Profiler::Frame> history; // Ring of completed frames
+static int historyNext = 0;                  // Slot the next frame goes into
+static long long framesRecorded = 0;
+static Profiler::Frame current = Profiler::Frame();
+static Uint64 lastFrameEnd = 0;
+
+static const char* const zoneNames[ZONE_COUNT] = {
+    "handleEvents", "update", "generateChunk", "mapRender", "playerRender", "present"
+};
+static const char* const counterNames[COUNTER_COUNT] = {"loadedChunks", "drawCalls"};
+
+void Profiler::record(ProfileZone zone, Uint64 start, Uint64 end) {
+    Uint64 index = writeIndex.fetch_add(1, std::memory_order_relaxed);
+    ProfileEvent& event = ring[index & (RING_SIZE - 1)];
+    event.sequence.store(2 * index + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    event.start.store(start, std::memory_order_relaxed);
+    event.end.store(end, std::memory_order_relaxed);
+    event.zone.store(zone, std::memory_order_relaxed);
+    event.sequence.store(2 * index + 2, std::memory_order_release);
+}
+
+void Profiler::setCounter(ProfileCounter counter, int value) {
+    current.counters[counter] = value;
+}
+
+// Adds every complete event to the current frame. An event still being
+// written stops the scan and is picked up by the next frame
+static void drainRing() {
+    Uint64 written = writeIndex.load(std::memory_order_acquire);
+    if (written - readIndex > static_cast<Uint64>(Profiler::RING_SIZE)) {
+        droppedEvents += static_cast<long long>(written - Profiler::RING_SIZE - readIndex);
+        readIndex = written - Profiler::RING_SIZE;
+    }
+
+    double msPerCount = 1000.0 / SDL_GetPerformanceFrequency();
+    for (; readIndex < written; ++readIndex) {
+        ProfileEvent& event = ring[readIndex & (Profiler::RING_SIZE - 1)];
+        Uint64 expected = 2 * readIndex + 2;
+        Uint64 sequence = event.sequence.load(std::memory_order_acquire);
+        if (sequence < expected) break;
+
+        if (sequence == expected) {
+            Uint64 start = event.start.load(std::memory_order_relaxed);
+            Uint64 end = event.end.load(std::memory_order_relaxed);
+            int zone = event.zone.load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (event.sequence.load(std::memory_order_relaxed) == expected && zone >= 0 && zone < ZONE_COUNT) {
+                current.zoneMs[zone] += static_cast<float>((end - start) * msPerCount);
+                ++current.zoneCalls[zone];
+                continue;
+            }
+        }
+        ++droppedEvents; // Overwritten by a writer that lapped the ring
+    }
+}
+
+void Profiler::endFrame() {
+    Uint64 now = SDL_GetPerformanceCounter();
+    drainRing();
+
+    // The first call only marks where the first frame starts
+    if (lastFrameEnd != 0) {
+        current.frameMs = static_cast<float>((now - lastFrameEnd) * 1000.0 / SDL_GetPerformanceFrequency());
+        if (history.size() < static_cast<size_t>(HISTORY_FRAMES)) {
+            history.push_back(current);
+        } else {
+            history[historyNext] = current;
+        }
+        historyNext = (historyNext + 1) % HISTORY_FRAMES;
+        ++framesRecorded;
+    }
+    lastFrameEnd = now;
+    current = Frame();
+}
+
+int Profiler::getFrameCount() {
+    return static_cast<int>(history.size());
+}
+
+const Profiler::Frame& Profiler::getFrame(int ago) {
+    int size = static_cast<int>(history.size());
+    return history[((historyNext - 1 - ago) % size + size) % size];
+}
+
+float Profiler::getFramePercentile(float fraction, int frames) {
+    int count = std::min(frames, getFrameCount());
+    if (count <= 0) return 0.0f;
+
+    std::vector<float> times(count);
+    for (int i = 0; i < count; ++i) {
+        times[i] = getFrame(i).frameMs;
+    }
+    int rank = std::min(count - 1, static_cast<int>(fraction * count));
+    std::nth_element(times.begin(), times.begin() + rank, times.end());
+    return times[rank];
+}
+
+float Profiler::getCallsPerSecond(ProfileZone zone) {
+    float elapsedMs = 0.0f;
+    int calls = 0;
+    for (int i = 0; i < getFrameCount() && elapsedMs < 1000.0f; ++i) {
+        const Frame& frame = getFrame(i);
+        elapsedMs += frame.frameMs;
+        calls += frame.zoneCalls[zone];
+    }
+    return elapsedMs > 0.0f ? calls * 1000.0f / elapsedMs : 0.0f;
+}
+
+long long Profiler::getDroppedEvents() {
+    return droppedEvents;
+}
+
+const char* Profiler::getZoneName(ProfileZone zone) {
+    return zoneNames[zone];
+}
+
+const char* Profiler::getCounterName(ProfileCounter counter) {
+    return counterNames[counter];
+}
+
+bool Profiler::writeCsv(const char* filePath) {
+    std::ofstream file(filePath);
+    if (!file) {
+        std::cerr << "Could not write profile to " << filePath << std::endl;
+        return false;
+    }
+
+    file << "frame,frame_ms";
+    for (int zone = 0; zone < ZONE_COUNT; ++zone) {
+        file << "," << zoneNames[zone] << "_ms," << zoneNames[zone] << "_calls";
+    }
+    for (int counter = 0; counter < COUNTER_COUNT; ++counter) {
+        file << "," << counterNames[counter];
+    }
+    file << "\n";
+
+    // Oldest first, numbered from the start of the run
+    long long number = framesRecorded - getFrameCount();
+    for (int ago = getFrameCount() - 1; ago >= 0; --ago) {
+        const Frame& frame = getFrame(ago);
+        file << number++ << "," << frame.frameMs;
+        for (int zone = 0; zone < ZONE_COUNT; ++zone) {
+            file << "," << frame.zoneMs[zone] << "," << frame.zoneCalls[zone];
+        }
+        for (int counter = 0; counter < COUNTER_COUNT; ++counter) {
+            file << "," << frame.counters[counter];
+        }
+        file << "\n";
+    }
+    return static_cast<bool>(file);
+}
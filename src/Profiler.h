@@ -0,0 +1,87 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <SDL.h>
+
+// Subsystems timed by PROFILE_ZONE
+enum ProfileZone {
+    ZONE_HANDLE_EVENTS,
+    ZONE_UPDATE,
+    ZONE_GENERATE_CHUNK, // Summed over the generation threads, so it can exceed the frame
+    ZONE_MAP_RENDER,
+    ZONE_PLAYER_RENDER,
+    ZONE_PRESENT,
+    ZONE_COUNT
+};
+
+// Values sampled once per frame by the game
+enum ProfileCounter {
+    COUNTER_LOADED_CHUNKS,
+    COUNTER_DRAW_CALLS,
+    COUNTER_COUNT
+};
+
+// Per-frame timing breakdown. Scoped zones record their start and end into a
+// lock-free ring from any thread; once per frame, endFrame() on the main
+// thread folds the ring into a frame record next to the sampled counters.
+// The most recent frames feed the overlay, and writeCsv() exports them.
+//
+// Zones only exist when GAME_PROFILER is defined (every build type except
+// Release and MinSizeRel, or any build with ENABLE_PROFILER); otherwise
+// PROFILE_ZONE expands to nothing.
+class Profiler {
+public:
+    static const int RING_SIZE = 4096;       // Zone events between two endFrame() calls; a power of two
+    static const int HISTORY_FRAMES = 36000; // Frames kept for the overlay and CSV (ten minutes at 60 FPS)
+
+    struct Frame {
+        float frameMs;               // From the previous endFrame() to this one
+        float zoneMs[ZONE_COUNT];
+        int zoneCalls[ZONE_COUNT];
+        int counters[COUNTER_COUNT];
+    };
+
+    class Scope {
+    public:
+        explicit Scope(ProfileZone zone) : zone(zone), start(SDL_GetPerformanceCounter()) {}
+        ~Scope() { record(zone, start, SDL_GetPerformanceCounter()); }
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        ProfileZone zone;
+        Uint64 start;
+    };
+
+    // Thread-safe and wait-free; events are dropped if the ring laps the reader
+    static void record(ProfileZone zone, Uint64 start, Uint64 end);
+
+    // The rest is for the main thread only
+    static void setCounter(ProfileCounter counter, int value);
+    // Closes the current frame
+    static void endFrame();
+    // Frames recorded so far, up to HISTORY_FRAMES
+    static int getFrameCount();
+    // `ago` frames before the last completed one
+    static const Frame& getFrame(int ago);
+    // Frame time in milliseconds at `fraction` (0.5 for the median) over the last `frames` frames
+    static float getFramePercentile(float fraction, int frames);
+    // Zone calls per second over roughly the last second
+    static float getCallsPerSecond(ProfileZone zone);
+    // Events lost to a full ring or torn by a concurrent overwrite
+    static long long getDroppedEvents();
+    static const char* getZoneName(ProfileZone zone);
+    static const char* getCounterName(ProfileCounter counter);
+    // One row per kept frame; returns false if the file cannot be written
+    static bool writeCsv(const char* filePath);
+};
+
+#ifdef GAME_PROFILER
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+#define PROFILE_ZONE(zone) Profiler::Scope PROFILE_CONCAT(profileScope, __LINE__)(zone)
+#else
+#define PROFILE_ZONE(zone)
+#endif
+
+#endif
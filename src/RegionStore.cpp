@@ -0,0 +1,485 @@
+#include "RegionStore.h"
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include <utility>
+#include <iostream>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define REGIONSTORE_MMAP 1
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+#include <dirent.h>
+#elif defined(_WIN32)
+#include <direct.h>
+#include <io.h>
+#endif
+
+namespace {
+
+const char MAGIC[4] = {'G', 'R', 'G', 'N'};
+const int STAMP_WORDS = 6;
+const int TABLE_ENTRIES = RegionStore::REGION_CHUNKS * RegionStore::REGION_CHUNKS;
+const Uint32 HEADER_SIZE = (STAMP_WORDS + 2 * TABLE_ENTRIES) * 4;
+const int MAX_OPEN_REGIONS = 8;
+
+void putU32(Uint8* out, Uint32 value) {
+    out[0] = static_cast<Uint8>(value);
+    out[1] = static_cast<Uint8>(value >> 8);
+    out[2] = static_cast<Uint8>(value >> 16);
+    out[3] = static_cast<Uint8>(value >> 24);
+}
+
+Uint32 getU32(const Uint8* in) {
+    return in[0] | (in[1] << 8) | (in[2] << 16) | (static_cast<Uint32>(in[3]) << 24);
+}
+
+void makeDirectory(const std::string& path) {
+#if defined(_WIN32)
+    _mkdir(path.c_str());
+#else
+    mkdir(path.c_str(), 0755);
+#endif
+}
+
+// Creates every missing folder along `path`
+void makeDirectories(const std::string& path) {
+    for (size_t i = 1; i <= path.size(); ++i) {
+        if (i == path.size() || path[i] == '/' || path[i] == '\\') {
+            makeDirectory(path.substr(0, i));
+        }
+    }
+}
+
+// Entries of a folder, without "." and ".."
+std::vector<std::string> listDirectory(const std::string& path) {
+    std::vector<std::string> names;
+#if defined(_WIN32)
+    struct _finddata_t info;
+    intptr_t handle = _findfirst((path + "/*").c_str(), &info);
+    if (handle == -1) return names;
+    do {
+        names.push_back(info.name);
+    } while (_findnext(handle, &info) == 0);
+    _findclose(handle);
+#else
+    DIR* dir = opendir(path.c_str());
+    if (!dir) return names;
+    while (struct dirent* entry = readdir(dir)) {
+        names.push_back(entry->d_name);
+    }
+    closedir(dir);
+#endif
+    names.erase(std::remove_if(names.begin(), names.end(), [](const std::string& name) {
+        return name == "." || name == "..";
+    }), names.end());
+    return names;
+}
+
+void removeDirectory(const std::string& path) {
+#if defined(_WIN32)
+    _rmdir(path.c_str());
+#else
+    rmdir(path.c_str());
+#endif
+}
+
+// Deletes a seed folder; it only ever holds region files
+void removeSeedDirectory(const std::string& path) {
+    for (const std::string& name : listDirectory(path)) {
+        remove((path + "/" + name).c_str());
+    }
+    removeDirectory(path);
+}
+
+// Whether a table entry points at a payload that lies wholly in a file of
+// `fileSize` bytes, past the header
+bool payloadFits(Uint32 offset, Uint32 length, Uint32 fileSize) {
+    return length > 0 && offset >= HEADER_SIZE && static_cast<Uint64>(offset) + length <= fileSize;
+}
+
+bool isSeedName(const std::string& name) {
+    return !name.empty() && name.size() <= 10 && name.find_first_not_of("0123456789") == std::string::npos;
+}
+
+}
+
+struct RegionStore::Region {
+    int regionX;
+    int regionY;
+    FILE* file;
+    Uint32 fileSize;
+    Uint32 table[2 * TABLE_ENTRIES]; // In-memory copy of the offset/length table
+    const Uint8* map;                // Read-only view of the file, may lag behind fileSize
+    size_t mapSize;
+    Uint64 lastUse;
+};
+
+RegionStore::RegionStore(const std::string& directory, unsigned int seed, Uint32 generatorVersion)
+    : baseDirectory(directory), seed(seed), generatorVersion(generatorVersion), directoryUsed(false),
+      useCounter(0), writerBusy(false), stopping(false), loads(0), misses(0), writes(0) {
+    this->directory = baseDirectory + "/" + std::to_string(seed);
+    jobs.reserve(64);
+    writer = std::thread(&RegionStore::writerLoop, this);
+}
+
+RegionStore::~RegionStore() {
+    flush();
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        stopping = true;
+    }
+    jobsReady.notify_all();
+    writer.join();
+    closeAllRegions();
+}
+
+void RegionStore::reset(unsigned int newSeed) {
+    flush();
+    std::lock_guard<std::mutex> fileLock(fileMutex);
+    std::lock_guard<std::mutex> queueLock(queueMutex);
+    closeAllRegions();
+    seed = newSeed;
+    directory = baseDirectory + "/" + std::to_string(seed);
+    directoryUsed = false;
+}
+
+// Creates the seed's folder and marks the seed as played, once per seed
+void RegionStore::useDirectory() {
+    if (directoryUsed) return;
+    makeDirectories(directory);
+    pruneSeeds();
+    directoryUsed = true;
+}
+
+// Moves the current seed to the front of the "recent" list and deletes the
+// folders of every seed past KEPT_SEEDS. Folders the list does not mention
+// predate it, so they count as the oldest
+void RegionStore::pruneSeeds() {
+    std::string indexPath = baseDirectory + "/recent";
+    std::vector<std::string> recent(1, std::to_string(seed));
+    FILE* index = fopen(indexPath.c_str(), "r");
+    if (index) {
+        char line[32];
+        while (fgets(line, sizeof(line), index)) {
+            std::string name(line);
+            name.erase(name.find_last_not_of("\r\n") + 1);
+            if (isSeedName(name) && std::find(recent.begin(), recent.end(), name) == recent.end()) {
+                recent.push_back(name);
+            }
+        }
+        fclose(index);
+    }
+    for (const std::string& name : listDirectory(baseDirectory)) {
+        if (isSeedName(name) && std::find(recent.begin(), recent.end(), name) == recent.end()) {
+            recent.push_back(name);
+        }
+    }
+
+    for (size_t i = KEPT_SEEDS; i < recent.size(); ++i) {
+        removeSeedDirectory(baseDirectory + "/" + recent[i]);
+    }
+    if (recent.size() > static_cast<size_t>(KEPT_SEEDS)) {
+        recent.resize(KEPT_SEEDS);
+    }
+
+    index = fopen(indexPath.c_str(), "w");
+    if (!index) {
+        std::cerr << "Failed to write the seed list: " << indexPath << std::endl;
+        return;
+    }
+    for (const std::string& name : recent) {
+        fprintf(index, "%s\n", name.c_str());
+    }
+    fclose(index);
+}
+
+void RegionStore::removeAll(const std::string& directory) {
+    for (const std::string& name : listDirectory(directory)) {
+        if (isSeedName(name)) {
+            removeSeedDirectory(directory + "/" + name);
+        } else {
+            remove((directory + "/" + name).c_str());
+        }
+    }
+    removeDirectory(directory);
+}
+
+std::string RegionStore::regionPath(int regionX, int regionY) const {
+    return directory + "/r." + std::to_string(regionX) + "." + std::to_string(regionY) + ".rgn";
+}
+
+// Run-length encoding as (count, tile) byte pairs; terrain is mostly long
+// runs of one tile type, so a 32x32 chunk (1 KB) typically shrinks to about 130 bytes
+size_t RegionStore::compress(const Uint8* tiles, int count, std::vector<Uint8>& out) {
+    out.clear();
+    for (int i = 0; i < count;) {
+        Uint8 value = tiles[i];
+        int run = 1;
+        while (i + run < count && run < 255 && tiles[i + run] == value) {
+            ++run;
+        }
+        out.push_back(static_cast<Uint8>(run));
+        out.push_back(value);
+        i += run;
+    }
+    return out.size();
+}
+
+bool RegionStore::decompress(const Uint8* data, size_t length, Uint8* tiles, int count) {
+    int written = 0;
+    for (size_t i = 0; i + 1 < length; i += 2) {
+        int run = data[i];
+        if (run == 0 || written + run > count || data[i + 1] >= TILE_TYPE_COUNT) {
+            return false;
+        }
+        memset(tiles + written, data[i + 1], run);
+        written += run;
+    }
+    return written == count;
+}
+
+RegionStore::Region* RegionStore::openRegion(int regionX, int regionY, bool forWriting) {
+    for (Region* region : regions) {
+        if (region->regionX == regionX && region->regionY == regionY) {
+            region->lastUse = ++useCounter;
+            return region;
+        }
+    }
+
+    std::string path = regionPath(regionX, regionY);
+    FILE* file = fopen(path.c_str(), "r+b");
+    if (!file && !forWriting) {
+        return nullptr;
+    }
+    useDirectory();
+
+    Region* region = new Region();
+    region->regionX = regionX;
+    region->regionY = regionY;
+    region->map = nullptr;
+    region->mapSize = 0;
+    region->lastUse = ++useCounter;
+
+    std::vector<Uint8> header(HEADER_SIZE);
+    bool valid = file && fread(header.data(), 1, HEADER_SIZE, file) == HEADER_SIZE &&
+                 memcmp(header.data(), MAGIC, 4) == 0 &&
+                 getU32(&header[4]) == FORMAT_VERSION &&
+                 getU32(&header[8]) == generatorVersion &&
+                 getU32(&header[12]) == seed &&
+                 getU32(&header[16]) == static_cast<Uint32>(Chunk::SIZE);
+
+    if (valid) {
+        fseek(file, 0, SEEK_END);
+        region->fileSize = static_cast<Uint32>(ftell(file));
+        for (int i = 0; i < TABLE_ENTRIES; ++i) {
+            Uint32 offset = getU32(&header[(STAMP_WORDS + 2 * i) * 4]);
+            Uint32 length = getU32(&header[(STAMP_WORDS + 2 * i + 1) * 4]);
+            if (!payloadFits(offset, length, region->fileSize)) {
+                // Cut short by a crash or otherwise damaged: treat the chunk as
+                // not stored, so it is generated and appended again
+                offset = 0;
+                length = 0;
+            }
+            region->table[2 * i] = offset;
+            region->table[2 * i + 1] = length;
+        }
+    } else {
+        // Missing or stale (older generator, other seed): start the file over
+        if (file) fclose(file);
+        file = fopen(path.c_str(), "w+b");
+        if (!file) {
+            std::cerr << "Failed to open region file: " << path << std::endl;
+            delete region;
+            return nullptr;
+        }
+        std::fill(header.begin(), header.end(), 0);
+        memcpy(header.data(), MAGIC, 4);
+        putU32(&header[4], FORMAT_VERSION);
+        putU32(&header[8], generatorVersion);
+        putU32(&header[12], seed);
+        putU32(&header[16], Chunk::SIZE);
+        fwrite(header.data(), 1, HEADER_SIZE, file);
+        fflush(file);
+        std::fill(region->table, region->table + 2 * TABLE_ENTRIES, 0);
+        region->fileSize = HEADER_SIZE;
+    }
+    region->file = file;
+
+    if (static_cast<int>(regions.size()) >= MAX_OPEN_REGIONS) {
+        auto oldest = std::min_element(regions.begin(), regions.end(), [](const Region* a, const Region* b) {
+            return a->lastUse < b->lastUse;
+        });
+        closeRegion(*oldest);
+        regions.erase(oldest);
+    }
+    regions.push_back(region);
+    return region;
+}
+
+void RegionStore::closeRegion(Region* region) {
+#ifdef REGIONSTORE_MMAP
+    if (region->map) {
+        munmap(const_cast<Uint8*>(region->map), region->mapSize);
+    }
+#endif
+    fclose(region->file);
+    delete region;
+}
+
+void RegionStore::closeAllRegions() {
+    for (Region* region : regions) {
+        closeRegion(region);
+    }
+    regions.clear();
+}
+
+bool RegionStore::readPayload(Region* region, Uint32 offset, Uint32 length, Chunk& chunk) {
+    int count = Chunk::AREA;
+    chunk.tiles.resize(count);
+    if (!payloadFits(offset, length, region->fileSize)) {
+        return false;
+    }
+
+#ifdef REGIONSTORE_MMAP
+    if (static_cast<Uint64>(offset) + length > region->mapSize) {
+        // The file grew since it was mapped; map the whole thing again
+        if (region->map) {
+            munmap(const_cast<Uint8*>(region->map), region->mapSize);
+            region->map = nullptr;
+        }
+        void* view = mmap(nullptr, region->fileSize, PROT_READ, MAP_SHARED, fileno(region->file), 0);
+        if (view == MAP_FAILED) {
+            region->mapSize = 0;
+            return false;
+        }
+        region->map = static_cast<const Uint8*>(view);
+        region->mapSize = region->fileSize;
+    }
+    return decompress(region->map + offset, length, chunk.tiles.data(), count);
+#else
+    std::vector<Uint8> payload(length);
+    if (fseek(region->file, offset, SEEK_SET) != 0 || fread(payload.data(), 1, length, region->file) != length) {
+        return false;
+    }
+    return decompress(payload.data(), length, chunk.tiles.data(), count);
+#endif
+}
+
+bool RegionStore::load(unsigned int chunkSeed, int chunkX, int chunkY, Chunk& chunk) {
+    std::lock_guard<std::mutex> lock(fileMutex);
+    if (chunkSeed != seed) {
+        return false;
+    }
+
+    Region* region = openRegion(chunkX >> REGION_SHIFT, chunkY >> REGION_SHIFT, false);
+    int index = (chunkY & (REGION_CHUNKS - 1)) * REGION_CHUNKS + (chunkX & (REGION_CHUNKS - 1));
+    if (!region || region->table[2 * index + 1] == 0) {
+        ++misses;
+        return false;
+    }
+
+    if (!readPayload(region, region->table[2 * index], region->table[2 * index + 1], chunk)) {
+        ++misses;
+        return false;
+    }
+    ++loads;
+    return true;
+}
+
+void RegionStore::save(unsigned int chunkSeed, int chunkX, int chunkY, const Chunk& chunk) {
+    WriteJob job;
+    job.seed = chunkSeed;
+    job.chunkX = chunkX;
+    job.chunkY = chunkY;
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        if (chunkSeed != seed || stopping) return;
+        if (!spareBuffers.empty()) {
+            job.payload.swap(spareBuffers.back());
+            spareBuffers.pop_back();
+        }
+    }
+
+    // Compress on the calling (worker) thread; the writer only does file I/O
+    compress(chunk.tiles.data(), static_cast<int>(chunk.tiles.size()), job.payload);
+
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        jobs.push_back(std::move(job));
+    }
+    jobsReady.notify_one();
+}
+
+void RegionStore::writeChunk(WriteJob& job) {
+    std::lock_guard<std::mutex> lock(fileMutex);
+    if (job.seed != seed) return; // Queued just before a reset
+
+    Region* region = openRegion(job.chunkX >> REGION_SHIFT, job.chunkY >> REGION_SHIFT, true);
+    if (!region) return;
+
+    int index = (job.chunkY & (REGION_CHUNKS - 1)) * REGION_CHUNKS + (job.chunkX & (REGION_CHUNKS - 1));
+    if (region->table[2 * index + 1] != 0) {
+        return; // Chunks are deterministic; an existing copy is as good as a new one
+    }
+
+    // Append the payload first, then publish it in the table
+    Uint32 offset = region->fileSize;
+    Uint32 length = static_cast<Uint32>(job.payload.size());
+    fseek(region->file, offset, SEEK_SET);
+    if (fwrite(job.payload.data(), 1, length, region->file) != length) {
+        return;
+    }
+
+    Uint8 entry[8];
+    putU32(entry, offset);
+    putU32(entry + 4, length);
+    fseek(region->file, (STAMP_WORDS + 2 * index) * 4, SEEK_SET);
+    fwrite(entry, 1, sizeof(entry), region->file);
+    fflush(region->file);
+
+    region->fileSize = offset + length;
+    region->table[2 * index] = offset;
+    region->table[2 * index + 1] = length;
+    ++writes;
+}
+
+void RegionStore::writerLoop() {
+    std::vector<WriteJob> batch;
+    batch.reserve(64);
+
+    std::unique_lock<std::mutex> lock(queueMutex);
+    while (true) {
+        jobsReady.wait(lock, [this] { return stopping || !jobs.empty(); });
+        if (jobs.empty() && stopping) return;
+
+        batch.swap(jobs);
+        writerBusy = true;
+        lock.unlock();
+
+        for (auto& job : batch) {
+            writeChunk(job);
+        }
+
+        lock.lock();
+        for (auto& job : batch) {
+            spareBuffers.push_back(std::move(job.payload));
+        }
+        batch.clear();
+        writerBusy = false;
+        jobsDone.notify_all();
+    }
+}
+
+void RegionStore::flush() {
+    std::unique_lock<std::mutex> lock(queueMutex);
+    jobsDone.wait(lock, [this] { return jobs.empty() && !writerBusy; });
+}
+
+RegionStore::Stats RegionStore::getStats() const {
+    std::lock_guard<std::mutex> lock(fileMutex);
+    Stats stats = {loads, misses, writes};
+    return stats;
+}
@@ -0,0 +1,108 @@
+#ifndef REGIONSTORE_H
+#define REGIONSTORE_H
+
+#include "Chunk.h"
+#include <SDL.h>
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+// Persists generated chunks in region files of 32x32 chunks so revisiting
+// ground (in this session or a later one) is a small read instead of a full
+// generation. File layout, all integers little-endian uint32:
+//
+//   magic "GRGN", format version, generator version, seed, chunk size, 0
+//   offset/length table: one pair per chunk, row-major, 0/0 = not stored
+//   RLE-compressed chunk payloads, appended in the order they were written
+//
+// A file whose stamp does not match the current generator version, seed or
+// chunk size is treated as empty and rewritten. Reads go through a memory
+// map where the platform has one; writes are queued to a background thread.
+//
+// Every seed gets its own folder, created when its first chunk is written,
+// so a store nothing is saved to leaves the disk alone. The base folder's
+// "recent" file lists the seeds most recently played first; only KEPT_SEEDS
+// folders are kept, and the rest are deleted when another seed's folder is
+// first used.
+class RegionStore {
+public:
+    static const int REGION_SHIFT = 5;
+    static const int REGION_CHUNKS = 1 << REGION_SHIFT; // Chunks per region side
+    static const Uint32 FORMAT_VERSION = 1;
+    static const int KEPT_SEEDS = 8;
+
+    struct Stats {
+        long long loads;  // Chunks read back from disk
+        long long misses; // Lookups for chunks not on disk
+        long long writes; // Chunks written
+    };
+
+    RegionStore(const std::string& directory, unsigned int seed, Uint32 generatorVersion);
+    ~RegionStore();
+    RegionStore(const RegionStore&) = delete;
+    RegionStore& operator=(const RegionStore&) = delete;
+
+    // Finishes pending writes and switches to the folder of another seed
+    void reset(unsigned int newSeed);
+    // Both ignore requests for a seed other than the current one, so work
+    // started before a reset can never leak into the new world's files
+    bool load(unsigned int chunkSeed, int chunkX, int chunkY, Chunk& chunk);
+    void save(unsigned int chunkSeed, int chunkX, int chunkY, const Chunk& chunk);
+    // Blocks until every queued write has reached the file
+    void flush();
+
+    Stats getStats() const;
+
+    // Deletes a store's folder, every seed's region files included; no store
+    // may be using it
+    static void removeAll(const std::string& directory);
+
+private:
+    struct Region;
+    struct WriteJob {
+        unsigned int seed;
+        int chunkX;
+        int chunkY;
+        std::vector<Uint8> payload;
+    };
+
+    Region* openRegion(int regionX, int regionY, bool forWriting);
+    void closeRegion(Region* region);
+    void closeAllRegions();
+    bool readPayload(Region* region, Uint32 offset, Uint32 length, Chunk& chunk);
+    void writeChunk(WriteJob& job);
+    void writerLoop();
+    std::string regionPath(int regionX, int regionY) const;
+    void useDirectory();
+    void pruneSeeds();
+
+    static size_t compress(const Uint8* tiles, int count, std::vector<Uint8>& out);
+    static bool decompress(const Uint8* data, size_t length, Uint8* tiles, int count);
+
+    std::string baseDirectory;
+    std::string directory; // baseDirectory plus the seed
+    unsigned int seed; // Written under both mutexes, so either one is enough to read it
+    Uint32 generatorVersion;
+    bool directoryUsed; // The seed's folder exists and heads the recent list; guarded by fileMutex
+
+    // Open region files, guarded by fileMutex
+    std::vector<Region*> regions;
+    Uint64 useCounter;
+    mutable std::mutex fileMutex;
+
+    // Write queue, guarded by queueMutex
+    std::vector<WriteJob> jobs;
+    std::vector<std::vector<Uint8>> spareBuffers;
+    bool writerBusy;
+    bool stopping;
+    std::mutex queueMutex;
+    std::condition_variable jobsReady;
+    std::condition_variable jobsDone;
+    std::thread writer;
+
+    long long loads, misses, writes;
+};
+
+#endif
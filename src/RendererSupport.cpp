@@ -0,0 +1,29 @@
+#include "RendererSupport.h"
+#include <climits>
+#include <iostream>
+
+SDL_Renderer* RendererSupport::geometryFailedOn = nullptr;
+
+bool RendererSupport::geometryWorks(SDL_Renderer* renderer) {
+    return renderer && renderer != geometryFailedOn;
+}
+
+void RendererSupport::geometryFailed(SDL_Renderer* renderer) {
+    if (renderer == geometryFailedOn) return;
+    std::cerr << "SDL_RenderGeometry failed, drawing quads one by one: " << SDL_GetError() << std::endl;
+    geometryFailedOn = renderer;
+}
+
+bool RendererSupport::getMaxTextureSize(SDL_Renderer* renderer, int& width, int& height) {
+    SDL_RendererInfo info;
+    if (!renderer || SDL_GetRendererInfo(renderer, &info) != 0) return false;
+    // A max size of 0 means unlimited (e.g. the software renderer)
+    width = info.max_texture_width > 0 ? info.max_texture_width : INT_MAX;
+    height = info.max_texture_height > 0 ? info.max_texture_height : INT_MAX;
+    return true;
+}
+
+bool RendererSupport::fitsTexture(SDL_Renderer* renderer, int width, int height) {
+    int maxWidth, maxHeight;
+    return getMaxTextureSize(renderer, maxWidth, maxHeight) && width <= maxWidth && height <= maxHeight;
+}
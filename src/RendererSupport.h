@@ -0,0 +1,27 @@
+#ifndef RENDERERSUPPORT_H
+#define RENDERERSUPPORT_H
+
+#include <SDL.h>
+
+// What the renderer can take, for the code that picks between a fast path and
+// a fallback: whether SDL_RenderGeometry still works on it, and how large a
+// texture it accepts. A geometry failure is remembered for the renderer it
+// happened on, so every batch falls back together and it is logged once.
+class RendererSupport {
+public:
+    // False once SDL_RenderGeometry has failed on `renderer`
+    static bool geometryWorks(SDL_Renderer* renderer);
+    // Records a failed SDL_RenderGeometry call on `renderer`
+    static void geometryFailed(SDL_Renderer* renderer);
+
+    // Largest texture `renderer` accepts, INT_MAX on a side it does not
+    // limit; false if the renderer cannot be queried
+    static bool getMaxTextureSize(SDL_Renderer* renderer, int& width, int& height);
+    // Whether `renderer` accepts a texture of width x height
+    static bool fitsTexture(SDL_Renderer* renderer, int width, int height);
+
+private:
+    static SDL_Renderer* geometryFailedOn;
+};
+
+#endif
@@ -0,0 +1,212 @@
+#include "ScrollBuffer.h"
+#include "RendererSupport.h"
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+
+static int wrap(int a, int b) {
+    int r = a % b;
+    return r < 0 ? r + b : r;
+}
+
+ScrollBuffer::ScrollBuffer()
+    : renderer(nullptr), texture(nullptr), columns(0), rows(0), originX(0), originY(0),
+      valid(false), supported(false) {
+    stats.tilesDrawn = 0;
+    stats.copies = 0;
+    stats.drawCalls = 0;
+    stats.vertices = 0;
+    stats.fullRedraws = 0;
+}
+
+ScrollBuffer::~ScrollBuffer() {
+    clear();
+}
+
+// Makes sure the texture exists and covers the camera plus one tile of slack
+bool ScrollBuffer::prepare(SDL_Renderer* newRenderer, const SDL_Rect& camera) {
+    if (newRenderer != renderer) {
+        clear();
+        renderer = newRenderer;
+        supported = renderer && SDL_RenderTargetSupported(renderer);
+    }
+    if (!supported || camera.w <= 0 || camera.h <= 0) return false;
+
+    int neededColumns = (camera.w + Tile::SIZE - 1) / Tile::SIZE + 1;
+    int neededRows = (camera.h + Tile::SIZE - 1) / Tile::SIZE + 1;
+    if (texture && neededColumns == columns && neededRows == rows) return true;
+
+    clear();
+    if (!RendererSupport::fitsTexture(renderer, neededColumns * Tile::SIZE, neededRows * Tile::SIZE)) {
+        supported = false;
+        return false;
+    }
+    texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET,
+                                neededColumns * Tile::SIZE, neededRows * Tile::SIZE);
+    if (!texture) {
+        std::cerr << "Failed to create scroll buffer: " << SDL_GetError() << std::endl;
+        supported = false;
+        return false;
+    }
+    // The background is opaque, so skip blending when composing it
+    SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_NONE);
+    columns = neededColumns;
+    rows = neededRows;
+    return true;
+}
+
+bool ScrollBuffer::render(SDL_Renderer* newRenderer, const SDL_Rect& camera, const ChunkGrid& chunks) {
+    stats.tilesDrawn = 0;
+    stats.copies = 0;
+    stats.drawCalls = 0;
+    stats.vertices = 0;
+    if (!prepare(newRenderer, camera)) return false;
+
+    // Scroll the buffered window to the camera, queueing whatever it exposes
+    int newX = Chunk::floorDiv(camera.x, Tile::SIZE);
+    int newY = Chunk::floorDiv(camera.y, Tile::SIZE);
+    int moveX = newX - originX;
+    int moveY = newY - originY;
+    if (!valid || std::abs(moveX) >= columns || std::abs(moveY) >= rows) {
+        dirty.clear();
+        SDL_Rect everything = {newX, newY, columns, rows};
+        dirty.push_back(everything);
+        ++stats.fullRedraws;
+    } else {
+        if (moveX != 0) {
+            SDL_Rect exposed = {moveX > 0 ? originX + columns : newX, newY, std::abs(moveX), rows};
+            dirty.push_back(exposed);
+        }
+        if (moveY != 0) {
+            SDL_Rect exposed = {newX, moveY > 0 ? originY + rows : newY, columns, std::abs(moveY)};
+            dirty.push_back(exposed);
+        }
+    }
+    originX = newX;
+    originY = newY;
+    valid = true;
+
+    if (!dirty.empty()) {
+        SDL_Texture* previousTarget = SDL_GetRenderTarget(renderer);
+        if (SDL_SetRenderTarget(renderer, texture) != 0) {
+            valid = false;
+            return false;
+        }
+
+        placeholders.clear();
+        bool batching = batch.begin(renderer, Tile::getTilesetTexture());
+        for (const SDL_Rect& area : dirty) {
+            drawTiles(chunks, area, batching);
+        }
+        int vertices = batching ? batch.flush() : 0;
+        if (vertices > 0) {
+            ++stats.drawCalls;
+            stats.vertices += vertices;
+        } else if (vertices < 0) {
+            // The renderer refused the batch; draw the same tiles one by one
+            placeholders.clear();
+            stats.tilesDrawn = 0;
+            stats.drawCalls = 0;
+            stats.vertices = 0;
+            for (const SDL_Rect& area : dirty) {
+                drawTiles(chunks, area, false);
+            }
+        }
+        if (!placeholders.empty()) {
+            Uint8 r, g, b, a;
+            SDL_GetRenderDrawColor(renderer, &r, &g, &b, &a);
+            SDL_SetRenderDrawColor(renderer, 60, 60, 60, 255);
+            SDL_RenderFillRects(renderer, placeholders.data(), static_cast<int>(placeholders.size()));
+            ++stats.drawCalls;
+            stats.vertices += 4 * static_cast<int>(placeholders.size());
+            SDL_SetRenderDrawColor(renderer, r, g, b, a);
+        }
+        dirty.clear();
+        SDL_SetRenderTarget(renderer, previousTarget);
+    }
+
+    // The camera's top-left lands somewhere inside the wrapped texture; the
+    // parts right of and below the seam come from its left and top edges
+    int width = columns * Tile::SIZE;
+    int height = rows * Tile::SIZE;
+    int sourceX = wrap(camera.x, width);
+    int sourceY = wrap(camera.y, height);
+    int leftWidth = std::min(camera.w, width - sourceX);
+    int topHeight = std::min(camera.h, height - sourceY);
+    const SDL_Rect pieces[4][2] = {
+        {{sourceX, sourceY, leftWidth, topHeight}, {0, 0, leftWidth, topHeight}},
+        {{0, sourceY, camera.w - leftWidth, topHeight}, {leftWidth, 0, camera.w - leftWidth, topHeight}},
+        {{sourceX, 0, leftWidth, camera.h - topHeight}, {0, topHeight, leftWidth, camera.h - topHeight}},
+        {{0, 0, camera.w - leftWidth, camera.h - topHeight}, {leftWidth, topHeight, camera.w - leftWidth, camera.h - topHeight}},
+    };
+    for (const auto& piece : pieces) {
+        if (piece[0].w > 0 && piece[0].h > 0) {
+            SDL_RenderCopy(renderer, texture, &piece[0], &piece[1]);
+            ++stats.copies;
+            ++stats.drawCalls;
+            stats.vertices += 4;
+        }
+    }
+    return true;
+}
+
+// Draws the part of `area` (world tiles) that is inside the buffered window
+void ScrollBuffer::drawTiles(const ChunkGrid& chunks, const SDL_Rect& area, bool batching) {
+    int startX = std::max(area.x, originX);
+    int startY = std::max(area.y, originY);
+    int endX = std::min(area.x + area.w, originX + columns);
+    int endY = std::min(area.y + area.h, originY + rows);
+    const SDL_Rect origin = {0, 0, columns * Tile::SIZE, rows * Tile::SIZE};
+
+    for (int y = startY; y < endY; ++y) {
+        int pixelY = wrap(y, rows) * Tile::SIZE;
+        int chunkY = Chunk::chunkOf(y);
+        for (int x = startX; x < endX; ++x) {
+            int pixelX = wrap(x, columns) * Tile::SIZE;
+            const ChunkSlot* slot = chunks.find(Chunk::chunkOf(x), chunkY);
+            if (!slot) {
+                SDL_Rect placeholder = {pixelX, pixelY, Tile::SIZE, Tile::SIZE};
+                placeholders.push_back(placeholder);
+            } else if (batching) {
+                batch.add(slot->chunk.getTile(Chunk::offsetIn(x), Chunk::offsetIn(y)), pixelX, pixelY);
+            } else {
+                Tile::render(renderer, slot->chunk.getTile(Chunk::offsetIn(x), Chunk::offsetIn(y)), pixelX, pixelY, origin);
+                ++stats.drawCalls;
+                stats.vertices += 4;
+            }
+        }
+    }
+    stats.tilesDrawn += std::max(0, endX - startX) * std::max(0, endY - startY);
+}
+
+void ScrollBuffer::invalidate(int tileX, int tileY, int width, int height) {
+    if (!valid) return;
+    // Only what overlaps the window matters; the rest is drawn when it is exposed
+    if (tileX >= originX + columns || tileY >= originY + rows ||
+        tileX + width <= originX || tileY + height <= originY) {
+        return;
+    }
+    // Many scattered edits cost more to track than one redraw
+    if (dirty.size() >= 64) {
+        invalidateAll();
+        return;
+    }
+    SDL_Rect area = {tileX, tileY, width, height};
+    dirty.push_back(area);
+}
+
+void ScrollBuffer::invalidateAll() {
+    valid = false;
+    dirty.clear();
+}
+
+void ScrollBuffer::clear() {
+    if (texture) {
+        SDL_DestroyTexture(texture);
+        texture = nullptr;
+    }
+    columns = 0;
+    rows = 0;
+    valid = false;
+    dirty.clear();
+}
@@ -0,0 +1,59 @@
+#ifndef SCROLLBUFFER_H
+#define SCROLLBUFFER_H
+
+#include "ChunkGrid.h"
+#include "TileBatch.h"
+#include <SDL.h>
+#include <vector>
+
+// Background layer kept in a wrap-around offscreen texture one tile larger
+// than the screen. World tile (x, y) always lives at texture tile
+// (x mod columns, y mod rows), so when the camera moves only the tile
+// columns and rows it newly exposes are drawn; everything else is already
+// in place. The screen is then composed from at most four copies, one per
+// quadrant of the wrapped texture.
+class ScrollBuffer {
+public:
+    struct Stats {
+        int tilesDrawn; // Tiles rasterized into the texture by the last render()
+        int copies;     // Copies that composed the screen (at most four)
+        int drawCalls;  // Every call submitted, rasterizing included
+        int vertices;   // Their vertices, four per copied or filled rect
+        long long fullRedraws; // Times the whole texture had to be redrawn
+    };
+
+    ScrollBuffer();
+    ~ScrollBuffer();
+    ScrollBuffer(const ScrollBuffer&) = delete;
+    ScrollBuffer& operator=(const ScrollBuffer&) = delete;
+
+    // Draws the tiles under `camera`; tiles of chunks missing from `chunks`
+    // are drawn as placeholders. Returns false, having drawn nothing, when the
+    // renderer cannot render to a texture of the needed size
+    bool render(SDL_Renderer* renderer, const SDL_Rect& camera, const ChunkGrid& chunks);
+    // Redraws a rectangle of world tiles the next time it is visible
+    void invalidate(int tileX, int tileY, int width, int height);
+    // Redraws everything, e.g. after the render targets were reset
+    void invalidateAll();
+    // Destroys the texture; must run before the renderer is destroyed
+    void clear();
+
+    Stats getStats() const { return stats; }
+
+private:
+    bool prepare(SDL_Renderer* renderer, const SDL_Rect& camera);
+    void drawTiles(const ChunkGrid& chunks, const SDL_Rect& area, bool batching);
+
+    SDL_Renderer* renderer;
+    SDL_Texture* texture;
+    int columns, rows;       // Texture size in tiles
+    int originX, originY;    // World tile at the top-left of the buffered window
+    bool valid;              // The texture holds the window at originX, originY
+    bool supported;
+    TileBatch batch;
+    std::vector<SDL_Rect> dirty;        // Invalidated world tiles, drawn next frame
+    std::vector<SDL_Rect> placeholders; // Reused per frame
+    Stats stats;
+};
+
+#endif
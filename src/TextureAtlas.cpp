@@ -0,0 +1,158 @@
+#include "TextureAtlas.h"
+#include "RendererSupport.h"
+#include <SDL_image.h>
+#include <algorithm>
+#include <iostream>
+
+TextureAtlas::TextureAtlas() {
+}
+
+TextureAtlas::~TextureAtlas() {
+    clear();
+    freeSources();
+}
+
+int TextureAtlas::addSource(SDL_Surface* surface) {
+    if (!surface) return -1;
+    sources.push_back(surface);
+    return static_cast<int>(sources.size()) - 1;
+}
+
+int TextureAtlas::addImage(const char* filePath) {
+    SDL_Surface* surface = IMG_Load(filePath);
+    if (!surface) {
+        std::cerr << "Failed to load atlas image " << filePath << ": " << IMG_GetError() << std::endl;
+        return -1;
+    }
+    return addSource(surface);
+}
+
+void TextureAtlas::addRegion(const std::string& name, int source, const SDL_Rect& rect) {
+    if (source < 0 || source >= static_cast<int>(sources.size())) return;
+
+    // Clip to the source so a bad rect cannot read outside it
+    SDL_Rect bounds = {0, 0, sources[source]->w, sources[source]->h};
+    SDL_Rect clipped;
+    if (!SDL_IntersectRect(&rect, &bounds, &clipped)) {
+        std::cerr << "Atlas region " << name << " lies outside its image" << std::endl;
+        return;
+    }
+    Pending entry = {name, source, clipped};
+    pending.push_back(entry);
+}
+
+void TextureAtlas::addGlyphs(const std::string& prefix, TTF_Font* font, char first, char last) {
+    if (!font) return;
+    const SDL_Color white = {255, 255, 255, 255};
+    for (int c = first; c <= last; ++c) {
+        SDL_Surface* glyph = TTF_RenderGlyph_Blended(font, static_cast<Uint16>(c), white);
+        int source = addSource(glyph);
+        if (source < 0) continue;
+        SDL_Rect rect = {0, 0, glyph->w, glyph->h};
+        addRegion(prefix + static_cast<char>(c), source, rect);
+    }
+}
+
+bool TextureAtlas::build(SDL_Renderer* renderer) {
+    clear();
+
+    int pageWidth = PAGE_SIZE;
+    int pageHeight = PAGE_SIZE;
+    int maxWidth, maxHeight;
+    if (RendererSupport::getMaxTextureSize(renderer, maxWidth, maxHeight)) {
+        pageWidth = std::min(pageWidth, maxWidth);
+        pageHeight = std::min(pageHeight, maxHeight);
+    }
+
+    // Shelf packing, tallest first: regions fill a row left to right, rows
+    // stack down the page, and a new page starts when one is full
+    std::vector<size_t> order(pending.size());
+    for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+    std::stable_sort(order.begin(), order.end(), [this](size_t a, size_t b) {
+        return pending[a].rect.h > pending[b].rect.h;
+    });
+
+    std::vector<int> placedPage(pending.size(), -1);
+    std::vector<SDL_Rect> placedRect(pending.size());
+    std::vector<int> usedHeight;
+    int x = 0, y = 0, shelfHeight = 0;
+    for (size_t i : order) {
+        const SDL_Rect& rect = pending[i].rect;
+        if (rect.w > pageWidth || rect.h > pageHeight) {
+            std::cerr << "Atlas region " << pending[i].name << " does not fit on a page" << std::endl;
+            continue;
+        }
+        if (x + rect.w > pageWidth) {
+            x = 0;
+            y += shelfHeight;
+            shelfHeight = 0;
+        }
+        if (usedHeight.empty() || y + rect.h > pageHeight) {
+            usedHeight.push_back(0);
+            x = 0;
+            y = 0;
+            shelfHeight = 0;
+        }
+        placedPage[i] = static_cast<int>(usedHeight.size()) - 1;
+        placedRect[i] = {x, y, rect.w, rect.h};
+        x += rect.w + PADDING;
+        shelfHeight = std::max(shelfHeight, rect.h + PADDING);
+        usedHeight.back() = std::max(usedHeight.back(), y + rect.h);
+    }
+
+    // Pages are only as tall as their contents
+    for (size_t page = 0; page < usedHeight.size(); ++page) {
+        SDL_Surface* surface = SDL_CreateRGBSurfaceWithFormat(0, pageWidth, usedHeight[page], 32, SDL_PIXELFORMAT_RGBA32);
+        if (!surface) {
+            std::cerr << "Failed to create atlas page: " << SDL_GetError() << std::endl;
+            pages.push_back(nullptr);
+            continue;
+        }
+        SDL_FillRect(surface, nullptr, SDL_MapRGBA(surface->format, 0, 0, 0, 0));
+        for (size_t i = 0; i < pending.size(); ++i) {
+            if (placedPage[i] != static_cast<int>(page)) continue;
+            // Copy alpha as is rather than blending onto the empty page
+            SDL_Surface* source = sources[pending[i].source];
+            SDL_SetSurfaceBlendMode(source, SDL_BLENDMODE_NONE);
+            SDL_BlitSurface(source, &pending[i].rect, surface, &placedRect[i]);
+        }
+
+        SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, surface);
+        SDL_FreeSurface(surface);
+        if (!texture) {
+            std::cerr << "Failed to create atlas texture: " << SDL_GetError() << std::endl;
+        } else {
+            SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+        }
+        pages.push_back(texture);
+    }
+
+    for (size_t i = 0; i < pending.size(); ++i) {
+        if (placedPage[i] < 0 || !pages[placedPage[i]]) continue;
+        Region region = {pages[placedPage[i]], placedRect[i]};
+        regions[pending[i].name] = region;
+    }
+    pending.clear();
+    freeSources();
+    return !regions.empty();
+}
+
+const TextureAtlas::Region* TextureAtlas::find(const std::string& name) const {
+    auto it = regions.find(name);
+    return it != regions.end() ? &it->second : nullptr;
+}
+
+void TextureAtlas::clear() {
+    for (SDL_Texture* page : pages) {
+        if (page) SDL_DestroyTexture(page);
+    }
+    pages.clear();
+    regions.clear();
+}
+
+void TextureAtlas::freeSources() {
+    for (SDL_Surface* source : sources) {
+        SDL_FreeSurface(source);
+    }
+    sources.clear();
+}
@@ -0,0 +1,62 @@
+#ifndef TEXTUREATLAS_H
+#define TEXTUREATLAS_H
+
+#include <SDL.h>
+#include <SDL_ttf.h>
+#include <map>
+#include <string>
+#include <vector>
+
+// Packs sprites from several images, plus pre-rasterized glyphs, into as few
+// texture pages as possible so a batch only breaks when the page changes.
+// Regions are queued under a name, build() packs and uploads them, and from
+// then on find() returns the page and rect to draw each one from.
+class TextureAtlas {
+public:
+    struct Region {
+        SDL_Texture* texture; // Page holding the region
+        SDL_Rect rect;        // Pixels within the page
+    };
+
+    static const int PAGE_SIZE = 1024; // Page width and maximum height, unless the renderer allows less
+    static const int PADDING = 1;      // Transparent gap between regions
+
+    TextureAtlas();
+    ~TextureAtlas();
+    TextureAtlas(const TextureAtlas&) = delete;
+    TextureAtlas& operator=(const TextureAtlas&) = delete;
+
+    // Takes ownership of `surface` until build(); returns its index, or -1 if it is null
+    int addSource(SDL_Surface* surface);
+    // Loads an image as a source; returns -1 if it cannot be read
+    int addImage(const char* filePath);
+    // Queues part of a source under `name`
+    void addRegion(const std::string& name, int source, const SDL_Rect& rect);
+    // Rasterizes characters `first` to `last` in white, named `prefix` plus the character
+    void addGlyphs(const std::string& prefix, TTF_Font* font, char first, char last);
+
+    // Packs every queued region and uploads the pages. Sources are freed
+    // either way; returns false if nothing could be uploaded
+    bool build(SDL_Renderer* renderer);
+    // Null if there is no region called `name`
+    const Region* find(const std::string& name) const;
+    int getPageCount() const { return static_cast<int>(pages.size()); }
+    // Destroys the pages; must run before the renderer is destroyed
+    void clear();
+
+private:
+    struct Pending {
+        std::string name;
+        int source;
+        SDL_Rect rect; // Within the source
+    };
+
+    void freeSources();
+
+    std::vector<SDL_Surface*> sources;
+    std::vector<Pending> pending;
+    std::vector<SDL_Texture*> pages;
+    std::map<std::string, Region> regions;
+};
+
+#endif
@@ -1,4 +1,5 @@
 #include "Tile.h"
+#include "TextureAtlas.h"
 #include <SDL_image.h>
 #include <nlohmann/json.hpp>
 #include <fstream>
@@ -8,13 +9,12 @@ using json = nlohmann::json;
 
 // Static member initialization
 SDL_Texture* Tile::tilesetTexture = nullptr;
-json Tile::tileProperties = json();
-
-// Constructor
-Tile::Tile(TileType type, int x, int y) : type(type) {
-    destRect = {x, y, 32, 32}; // Size and position on the screen
-    setPropertiesFromJson();
-}
+bool Tile::ownsTilesetTexture = false;
+TileProperties Tile::properties[TILE_TYPE_COUNT] = {};
+SDL_Rect Tile::drawRects[TILE_TYPE_COUNT] = {};
+const char* const Tile::names[TILE_TYPE_COUNT] = {
+    "GRASS", "WATER", "SAND", "SNOW", "DEEP_WATER", "MUD", "ICE", "SNOWY_GRASS", "SNOWY_SAND", "SNOWY_MUD"
+};
 
 // Load the tileset texture
 void Tile::loadTilesetTexture(SDL_Renderer* renderer, const char* filePath) {
@@ -23,69 +23,120 @@ void Tile::loadTilesetTexture(SDL_Renderer* renderer, const char* filePath) {
         std::cerr << "Failed to load texture: " << SDL_GetError() << std::endl;
         return;
     }
-    if (Tile::tilesetTexture != nullptr) {
-        SDL_DestroyTexture(Tile::tilesetTexture);
-    }
+    freeTilesetTexture();
     Tile::tilesetTexture = newTexture;
+    ownsTilesetTexture = true;
 }
 
-// Load and parse the JSON file for tile properties
-void Tile::loadTileProperties(const std::string& filePath) {
-    std::ifstream file(filePath);
-    if (file.is_open()) {
-        file >> Tile::tileProperties;
-    } else {
-        std::cerr << "Failed to open tile properties file: " << filePath << std::endl;
+void Tile::addToAtlas(TextureAtlas& atlas, const char* filePath) {
+    int source = atlas.addImage(filePath);
+    for (int i = 0; i < TILE_TYPE_COUNT; ++i) {
+        atlas.addRegion(std::string("tile/") + names[i], source, properties[i].srcRect);
     }
 }
 
-// Free the tileset texture
-void Tile::freeTilesetTexture() {
-    if (Tile::tilesetTexture != nullptr) {
-        SDL_DestroyTexture(Tile::tilesetTexture);
-        tilesetTexture = nullptr;
+bool Tile::useAtlas(const TextureAtlas& atlas) {
+    const TextureAtlas::Region* regions[TILE_TYPE_COUNT];
+    for (int i = 0; i < TILE_TYPE_COUNT; ++i) {
+        regions[i] = atlas.find(std::string("tile/") + names[i]);
+        // Tiles are batched from a single texture
+        if (!regions[i] || regions[i]->texture != regions[0]->texture) {
+            std::cerr << "Tile " << names[i] << " is missing from the atlas page" << std::endl;
+            return false;
+        }
+    }
+
+    freeTilesetTexture();
+    tilesetTexture = regions[0]->texture;
+    ownsTilesetTexture = false;
+    for (int i = 0; i < TILE_TYPE_COUNT; ++i) {
+        drawRects[i] = regions[i]->rect;
+    }
+    return true;
+}
+
+void Tile::useTilesetRects() {
+    for (int i = 0; i < TILE_TYPE_COUNT; ++i) {
+        drawRects[i] = properties[i].srcRect;
     }
 }
 
-// Set properties based on JSON data
-void Tile::setPropertiesFromJson() {
-    std::string tileTypeName = getTileTypeName();
-    if (!Tile::tileProperties.contains(tileTypeName)) {
-        std::cerr << "Tile type not found in JSON: " << tileTypeName << std::endl;
+// Parse the JSON file once into the dense property table; nothing reads JSON after this
+void Tile::loadTileProperties(const std::string& filePath) {
+    std::ifstream file(filePath);
+    if (!file.is_open()) {
+        std::cerr << "Failed to open tile properties file: " << filePath << std::endl;
         return;
     }
 
-    json props = Tile::tileProperties[tileTypeName];
-    
-    // Set srcRect from JSON
-    if (props.contains("srcRect") && props["srcRect"].is_object()) {
-        json srcRectJson = props["srcRect"];
-        srcRect.x = srcRectJson.value("x", 0);
-        srcRect.y = srcRectJson.value("y", 0);
-        srcRect.w = srcRect.h = 32; // Assuming each tile is 32x32
-    } else {
-        std::cerr << "srcRect not found or invalid for tile type: " << tileTypeName << std::endl;
+    json tileProperties;
+    try {
+        file >> tileProperties;
+    } catch (const json::exception& e) {
+        std::cerr << "Failed to parse tile properties file: " << filePath << ": " << e.what() << std::endl;
+        return;
+    }
+
+    static const struct {
+        const char* key;
+        TileFlag flag;
+    } flagKeys[] = {
+        {"isFast", TILE_FAST},
+        {"isSlow", TILE_SLOW},
+        {"isSlippery", TILE_SLIPPERY},
+        {"isWater", TILE_WATER},
+        {"isHot", TILE_HOT},
+        {"canCollide", TILE_COLLIDE},
+    };
+
+    for (int i = 0; i < TILE_TYPE_COUNT; ++i) {
+        TileProperties& entry = properties[i];
+        entry.srcRect = {0, 0, SIZE, SIZE};
+        entry.soundId = 0;
+        entry.flags = 0;
+
+        auto props = tileProperties.find(names[i]);
+        if (props == tileProperties.end() || !props->is_object()) {
+            std::cerr << "Tile type not found in JSON: " << names[i] << std::endl;
+            continue;
+        }
+
+        // Types without their own art yet fall back to the first atlas cell
+        auto srcRect = props->find("srcRect");
+        if (srcRect != props->end() && srcRect->is_object()) {
+            entry.srcRect.x = srcRect->value("x", 0);
+            entry.srcRect.y = srcRect->value("y", 0);
+        }
+        entry.soundId = static_cast<Uint8>(props->value("soundId", 0));
+        for (const auto& flagKey : flagKeys) {
+            if (props->value(flagKey.key, false)) {
+                entry.flags |= flagKey.flag;
+            }
+        }
     }
 
-    // Set other properties here as needed
-    // Example: 
-    // bool isWater = props.value("isWater", false);
+    // Every Map parses the file again; an atlas in use keeps its own rects
+    if (ownsTilesetTexture || !tilesetTexture) {
+        useTilesetRects();
+    }
 }
 
-// Convert TileType enum to string for JSON key
-std::string Tile::getTileTypeName() {
-    switch (type) {
-        case GRASS: return "GRASS";
-        case WATER: return "WATER";
-        case SAND: return "SAND";
-        case SNOW: return "SNOW";
-        // ... Add cases for other tile types
-        default: return "UNKNOWN";
+// Free the tileset texture; an atlas page belongs to the atlas
+void Tile::freeTilesetTexture() {
+    if (Tile::tilesetTexture != nullptr && ownsTilesetTexture) {
+        SDL_DestroyTexture(Tile::tilesetTexture);
     }
+    tilesetTexture = nullptr;
+    ownsTilesetTexture = false;
+    useTilesetRects();
+}
+
+const char* Tile::getName(TileType type) {
+    return type < TILE_TYPE_COUNT ? names[type] : "UNKNOWN";
 }
 
-// Render method
-void Tile::render(SDL_Renderer* renderer, SDL_Rect& camera) {
-    SDL_Rect renderQuad = {destRect.x - camera.x, destRect.y - camera.y, destRect.w, destRect.h};
-    SDL_RenderCopy(renderer, Tile::tilesetTexture, &srcRect, &renderQuad);
+// Render a tile of the given type whose top-left corner is at world pixel (x, y)
+void Tile::render(SDL_Renderer* renderer, TileType type, int x, int y, const SDL_Rect& camera) {
+    SDL_Rect renderQuad = {x - camera.x, y - camera.y, SIZE, SIZE};
+    SDL_RenderCopy(renderer, Tile::tilesetTexture, &drawRects[type], &renderQuad);
 }
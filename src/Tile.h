@@ -2,9 +2,10 @@
 #define TILE_H
 
 #include <SDL.h>
-#include <nlohmann/json.hpp>
 #include <string>
 
+class TextureAtlas;
+
 enum TileType {
     GRASS,
     WATER,
@@ -17,26 +18,69 @@ enum TileType {
     SNOWY_SAND,
     SNOWY_MUD,
     // Add other tile types as needed
+    TILE_TYPE_COUNT
+};
+
+// Gameplay flags from tile_props.json, packed into TileProperties::flags
+enum TileFlag {
+    TILE_FAST       = 1 << 0,
+    TILE_SLOW       = 1 << 1,
+    TILE_SLIPPERY   = 1 << 2,
+    TILE_WATER      = 1 << 3,
+    TILE_HOT        = 1 << 4,
+    TILE_COLLIDE    = 1 << 5
 };
 
+struct TileProperties {
+    SDL_Rect srcRect; // Cell in the tileset image
+    Uint8 soundId;
+    Uint8 flags;      // TileFlag bits
+};
+
+// Tiles are stored as 1-byte IDs inside chunks; this class only knows how to
+// turn an ID plus a world position into the rects needed to draw it.
 class Tile {
 public:
-    Tile(TileType type, int x, int y);
-    void render(SDL_Renderer* renderer, SDL_Rect& camera);
-    TileType getType() const { return type; }
+    static const int SIZE = 32; // Width and height of a tile in pixels
+
+    static void render(SDL_Renderer* renderer, TileType type, int x, int y, const SDL_Rect& camera);
+    // Where the type is drawn from in getTilesetTexture()
+    static const SDL_Rect& getSrcRect(TileType type);
+    static const TileProperties& getProperties(TileType type);
+    static bool hasFlag(TileType type, TileFlag flag);
+    static const char* getName(TileType type);
     static void loadTilesetTexture(SDL_Renderer* renderer, const char* filePath);
+    static SDL_Texture* getTilesetTexture() { return tilesetTexture; }
     static void loadTileProperties(const std::string& filePath);
     static void freeTilesetTexture();
+    // Queues each type's cell of the tileset as region "tile/<name>"; needs
+    // the properties loaded first
+    static void addToAtlas(TextureAtlas& atlas, const char* filePath);
+    // Draws from the atlas from now on, whatever properties are loaded
+    // later. Fails, changing nothing, unless every type has a region and they
+    // all share one page
+    static bool useAtlas(const TextureAtlas& atlas);
 
 private:
-    TileType type;
-    SDL_Rect srcRect, destRect;
-    static SDL_Texture* tilesetTexture;
-    static nlohmann::json tileProperties;
+    static void useTilesetRects();
 
-    void setTileRect();
-    void setPropertiesFromJson();
-    std::string getTileTypeName();
+    static SDL_Texture* tilesetTexture;
+    static bool ownsTilesetTexture; // False when it is an atlas page
+    static TileProperties properties[TILE_TYPE_COUNT]; // Dense table indexed by TileType, filled from JSON
+    static SDL_Rect drawRects[TILE_TYPE_COUNT];        // Tileset cells, or atlas rects after useAtlas()
+    static const char* const names[TILE_TYPE_COUNT];   // JSON keys
 };
 
+inline const SDL_Rect& Tile::getSrcRect(TileType type) {
+    return drawRects[type];
+}
+
+inline const TileProperties& Tile::getProperties(TileType type) {
+    return properties[type];
+}
+
+inline bool Tile::hasFlag(TileType type, TileFlag flag) {
+    return (properties[type].flags & flag) != 0;
+}
+
 #endif
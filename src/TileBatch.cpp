@@ -0,0 +1,106 @@
+#include "TileBatch.h"
+#include "RendererSupport.h"
+
+TileBatch::TileBatch()
+    : renderer(nullptr), atlas(nullptr), texWidth(0), texHeight(0), texScaleX(0), texScaleY(0) {
+}
+
+bool TileBatch::isSupported() {
+#ifdef TILEBATCH_GEOMETRY
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool TileBatch::begin(SDL_Renderer* newRenderer, SDL_Texture* newAtlas) {
+#ifdef TILEBATCH_GEOMETRY
+    vertices.clear();
+    indices.clear();
+    renderer = newRenderer;
+    atlas = newAtlas;
+
+    int width, height;
+    if (!RendererSupport::geometryWorks(renderer) || !atlas ||
+        SDL_QueryTexture(atlas, nullptr, nullptr, &width, &height) != 0 || width <= 0 || height <= 0) {
+        atlas = nullptr;
+        return false;
+    }
+
+    // Vertex coordinates are normalised, so resolve every tile's corner once per batch
+    texScaleX = 1.0f / width;
+    texScaleY = 1.0f / height;
+    for (int i = 0; i < TILE_TYPE_COUNT; ++i) {
+        const SDL_Rect& src = Tile::getSrcRect(static_cast<TileType>(i));
+        texLeft[i] = src.x * texScaleX;
+        texTop[i] = src.y * texScaleY;
+    }
+    texWidth = Tile::SIZE * texScaleX;
+    texHeight = Tile::SIZE * texScaleY;
+    return true;
+#else
+    (void)newRenderer;
+    (void)newAtlas;
+    return false;
+#endif
+}
+
+void TileBatch::add(TileType type, int x, int y) {
+    float left = static_cast<float>(x);
+    float top = static_cast<float>(y);
+    const SDL_Color white = {255, 255, 255, 255};
+    addQuad(left, top, left + Tile::SIZE, top + Tile::SIZE, texLeft[type], texTop[type], texLeft[type] + texWidth,
+            texTop[type] + texHeight, white);
+}
+
+void TileBatch::add(const SDL_Rect& source, const SDL_Rect& dest, SDL_Color color) {
+    addQuad(static_cast<float>(dest.x), static_cast<float>(dest.y), static_cast<float>(dest.x + dest.w),
+            static_cast<float>(dest.y + dest.h), source.x * texScaleX, source.y * texScaleY,
+            (source.x + source.w) * texScaleX, (source.y + source.h) * texScaleY, color);
+}
+
+void TileBatch::addQuad(float left, float top, float right, float bottom, float u0, float v0, float u1, float v1,
+                        SDL_Color color) {
+#ifdef TILEBATCH_GEOMETRY
+    int first = static_cast<int>(vertices.size());
+    SDL_Vertex quad[4] = {
+        {{left, top}, color, {u0, v0}},
+        {{right, top}, color, {u1, v0}},
+        {{left, bottom}, color, {u0, v1}},
+        {{right, bottom}, color, {u1, v1}},
+    };
+    vertices.insert(vertices.end(), quad, quad + 4);
+
+    const int corners[6] = {0, 1, 2, 2, 1, 3};
+    for (int corner : corners) {
+        indices.push_back(first + corner);
+    }
+#else
+    (void)left; (void)top; (void)right; (void)bottom;
+    (void)u0; (void)v0; (void)u1; (void)v1; (void)color;
+#endif
+}
+
+int TileBatch::draw() {
+#ifdef TILEBATCH_GEOMETRY
+    int count = static_cast<int>(vertices.size());
+    if (count == 0) return 0;
+    if (!RendererSupport::geometryWorks(renderer)) return -1;
+    if (SDL_RenderGeometry(renderer, atlas, vertices.data(), count, indices.data(), static_cast<int>(indices.size())) != 0) {
+        RendererSupport::geometryFailed(renderer);
+        return -1;
+    }
+    return count;
+#else
+    return -1;
+#endif
+}
+
+int TileBatch::flush() {
+    int result = draw();
+#ifdef TILEBATCH_GEOMETRY
+    vertices.clear();
+#endif
+    indices.clear();
+    return result;
+}
@@ -0,0 +1,55 @@
+#ifndef TILEBATCH_H
+#define TILEBATCH_H
+
+#include "Tile.h"
+#include <SDL.h>
+#include <vector>
+
+// SDL_RenderGeometry appeared in SDL 2.0.18; older builds draw tile by tile
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+#define TILEBATCH_GEOMETRY 1
+#endif
+
+// Collects tiles as textured quads in one vertex/index buffer and submits
+// them with a single SDL_RenderGeometry call per atlas, instead of one
+// SDL_RenderCopy per tile. Buffers keep their capacity between frames.
+// Once SDL_RenderGeometry fails on a renderer, every batch refuses it.
+class TileBatch {
+public:
+    TileBatch();
+    static bool isSupported();
+
+    // Starts a batch drawn from `atlas` with `renderer`; false if batching
+    // is unavailable, in which case nothing should be added
+    bool begin(SDL_Renderer* renderer, SDL_Texture* atlas);
+    // Queues a tile whose top-left corner lands on screen pixel (x, y)
+    void add(TileType type, int x, int y);
+    // Queues `source` (atlas pixels) drawn over `dest`, its vertices tinted
+    // `color`; white glyphs take the text color this way
+    void add(const SDL_Rect& source, const SDL_Rect& dest, SDL_Color color);
+    // Draws the queued quads in one call and keeps them, for a batch that is
+    // drawn again unchanged. Returns the number of vertices submitted, or -1
+    // if the renderer refused them
+    int draw();
+    // Draws the queued quads like draw() and empties the batch
+    int flush();
+
+    bool isEmpty() const { return indices.empty(); }
+    int getTileCount() const { return static_cast<int>(indices.size() / 6); }
+
+private:
+    void addQuad(float left, float top, float right, float bottom, float u0, float v0, float u1, float v1,
+                 SDL_Color color);
+
+    SDL_Renderer* renderer;
+    SDL_Texture* atlas;
+    float texLeft[TILE_TYPE_COUNT], texTop[TILE_TYPE_COUNT]; // Normalised atlas corners
+    float texWidth, texHeight; // Of one tile
+    float texScaleX, texScaleY; // Atlas pixels to normalised coordinates
+#ifdef TILEBATCH_GEOMETRY
+    std::vector<SDL_Vertex> vertices;
+#endif
+    std::vector<int> indices;
+};
+
+#endif
@@ -5,8 +5,8 @@
 #include <string>
 #include <iostream>
 
-TitleScreen::TitleScreen(SDL_Renderer* renderer, int windowWidth, int windowHeight)
-    : renderer(renderer), uiManager(renderer, windowWidth, windowHeight) {
+TitleScreen::TitleScreen(SDL_Renderer* renderer, int windowWidth, int windowHeight, const TextureAtlas* atlas)
+    : renderer(renderer), uiManager(renderer, windowWidth, windowHeight, atlas) {
 }
 
 TitleScreen::~TitleScreen() {
@@ -41,6 +41,22 @@ void TitleScreen::render() {
     // Any additional rendering for TitleScreen
 }
 
+void TitleScreen::update() {
+    uiManager.update();
+}
+
+bool TitleScreen::needsRedraw() const {
+    return uiManager.needsRedraw();
+}
+
+void TitleScreen::invalidate() {
+    uiManager.invalidate();
+}
+
+int TitleScreen::getIdleTimeout() const {
+    return uiManager.getIdleTimeout();
+}
+
 void TitleScreen::handleWindowSizeChange(int newWidth, int newHeight) {
     uiManager.handleWindowSizeChange(newWidth, newHeight);
 }
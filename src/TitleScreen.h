@@ -9,10 +9,17 @@
 
 class TitleScreen {
 public:
-    explicit TitleScreen(SDL_Renderer* renderer, int windowWidth, int windowHeight);
+    explicit TitleScreen(SDL_Renderer* renderer, int windowWidth, int windowHeight, const TextureAtlas* atlas = nullptr);
     ~TitleScreen();
     void handleEvents(SDL_Event& event, GameState& gameState);
     void render();
+    void update();
+    // False while the window already shows the current state
+    bool needsRedraw() const;
+    // Forces the next render(), e.g. after the window was exposed
+    void invalidate();
+    // Milliseconds the caller may sleep waiting for input, or -1 for no limit
+    int getIdleTimeout() const;
     void handleWindowSizeChange(int newWidth, int newHeight);
     std::string getUIManagerSeedText() const;
 
@@ -1,13 +1,25 @@
 #include "Game.h"
+#include <cstring>
 
 int main(int argc, char* argv[]) {
+    // Each session's input is logged for tools/replay; --record picks another file, --no-record turns it off
+    const char* inputLogPath = ROOT_PATH "last_session.input";
+    for (int i = 1; i < argc; ++i) {
+        if (!strcmp(argv[i], "--record") && i + 1 < argc) inputLogPath = argv[++i];
+        else if (!strcmp(argv[i], "--no-record")) inputLogPath = nullptr;
+    }
+
     Game game;
     game.init("GNOMEI", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, 800, 600, false);
+    if (inputLogPath) {
+        game.recordInput(inputLogPath);
+    }
 
     while (game.running()) {
         game.handleEvents();
         game.update();
         game.render();
+        game.waitForNextFrame();
     }
 
     game.clean();
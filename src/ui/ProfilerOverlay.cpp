@@ -0,0 +1,103 @@
+#include "ProfilerOverlay.h"
+#include "UIManager.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <cstdio>
+
+static const float BUDGET_MS = 1000.0f / 60.0f;
+static const int GRAPH_HEIGHT = 100;
+static const float PIXELS_PER_MS = GRAPH_HEIGHT / (3.0f * BUDGET_MS); // Three frame budgets tall
+static const int BAR_WIDTH = 2;
+static const int MARGIN = 8;
+
+ProfilerOverlay::ProfilerOverlay(SDL_Renderer* renderer, const TextureAtlas* atlas)
+    : renderer(renderer), text(renderer, atlas, ROOT_PATH "assets/Fixedsys.ttf"), visible(false), lastRefresh(0) {
+}
+
+void ProfilerOverlay::refreshText() {
+    lines.clear();
+    if (Profiler::getFrameCount() == 0) return;
+
+    const Profiler::Frame& last = Profiler::getFrame(0);
+    char line[128];
+    snprintf(line, sizeof(line), "frame %.1f ms  p50 %.1f  p95 %.1f  p99 %.1f", last.frameMs,
+             Profiler::getFramePercentile(0.50f, GRAPH_FRAMES), Profiler::getFramePercentile(0.95f, GRAPH_FRAMES),
+             Profiler::getFramePercentile(0.99f, GRAPH_FRAMES));
+    lines.push_back(line);
+    snprintf(line, sizeof(line), "chunks %d loaded, %.1f/s generated", last.counters[COUNTER_LOADED_CHUNKS],
+             Profiler::getCallsPerSecond(ZONE_GENERATE_CHUNK));
+    lines.push_back(line);
+    snprintf(line, sizeof(line), "draw calls %d", last.counters[COUNTER_DRAW_CALLS]);
+    lines.push_back(line);
+
+    // Two zones to a line, in milliseconds
+    for (int zone = 0; zone < ZONE_COUNT; zone += 2) {
+        int length = 0;
+        for (int i = zone; i < std::min(zone + 2, static_cast<int>(ZONE_COUNT)); ++i) {
+            length += snprintf(line + length, sizeof(line) - length, "%s%s %.2f", i > zone ? "  " : "",
+                               Profiler::getZoneName(static_cast<ProfileZone>(i)), last.zoneMs[i]);
+        }
+        lines.push_back(line);
+    }
+
+    if (Profiler::getDroppedEvents() > 0) {
+        snprintf(line, sizeof(line), "dropped zone events %lld", Profiler::getDroppedEvents());
+        lines.push_back(line);
+    }
+}
+
+void ProfilerOverlay::render() {
+    if (!visible) return;
+
+    Uint32 now = SDL_GetTicks();
+    if (lines.empty() || now - lastRefresh >= TEXT_REFRESH_MS) {
+        refreshText();
+        lastRefresh = now;
+    }
+
+    int lineWidth, lineHeight;
+    text.measure("0", UIManager::FONT_SIZE, lineWidth, lineHeight);
+    int width = GRAPH_FRAMES * BAR_WIDTH;
+    for (const std::string& line : lines) {
+        text.measure(line, UIManager::FONT_SIZE, lineWidth, lineHeight);
+        width = std::max(width, lineWidth);
+    }
+
+    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+    SDL_Rect panel = {MARGIN, MARGIN, width + 2 * MARGIN,
+                      GRAPH_HEIGHT + static_cast<int>(lines.size()) * lineHeight + 3 * MARGIN};
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 160);
+    SDL_RenderFillRect(renderer, &panel);
+
+    // Newest frame on the right, one bar per frame, batched by color
+    int graphLeft = 2 * MARGIN;
+    int graphBottom = 2 * MARGIN + GRAPH_HEIGHT;
+    for (std::vector<SDL_Rect>& group : bars) {
+        group.clear();
+    }
+    int count = Profiler::getFrameCount();
+    if (count > GRAPH_FRAMES) count = GRAPH_FRAMES;
+    for (int ago = 0; ago < count; ++ago) {
+        float frameMs = Profiler::getFrame(ago).frameMs;
+        int height = std::min(GRAPH_HEIGHT, std::max(1, static_cast<int>(frameMs * PIXELS_PER_MS)));
+        SDL_Rect bar = {graphLeft + (GRAPH_FRAMES - 1 - ago) * BAR_WIDTH, graphBottom - height, BAR_WIDTH, height};
+        bars[frameMs <= BUDGET_MS ? 0 : frameMs <= 2 * BUDGET_MS ? 1 : 2].push_back(bar);
+    }
+    const SDL_Color barColors[3] = {{80, 200, 80, 255}, {230, 200, 60, 255}, {230, 70, 60, 255}};
+    for (int i = 0; i < 3; ++i) {
+        if (bars[i].empty()) continue;
+        SDL_SetRenderDrawColor(renderer, barColors[i].r, barColors[i].g, barColors[i].b, barColors[i].a);
+        SDL_RenderFillRects(renderer, bars[i].data(), static_cast<int>(bars[i].size()));
+    }
+    int budgetY = graphBottom - static_cast<int>(BUDGET_MS * PIXELS_PER_MS);
+    SDL_SetRenderDrawColor(renderer, 255, 255, 255, 120);
+    SDL_RenderDrawLine(renderer, graphLeft, budgetY, graphLeft + GRAPH_FRAMES * BAR_WIDTH, budgetY);
+    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_NONE);
+
+    const SDL_Color white = {255, 255, 255, 255};
+    int y = graphBottom + MARGIN;
+    for (const std::string& line : lines) {
+        text.draw(line, UIManager::FONT_SIZE, graphLeft, y, white);
+        y += lineHeight;
+    }
+}
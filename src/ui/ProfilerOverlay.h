@@ -0,0 +1,37 @@
+#ifndef PROFILEROVERLAY_H
+#define PROFILEROVERLAY_H
+
+#include <SDL.h>
+#include <string>
+#include <vector>
+#include "TextRenderer.h"
+
+// Draws the profiler's recent frames over the game: a frame-time graph with
+// the 60 FPS budget marked, frame-time percentiles, chunk and draw call
+// counters, and the zone breakdown of the last frame. The text is refreshed
+// a few times a second so it stays readable
+class ProfilerOverlay {
+public:
+    static const int GRAPH_FRAMES = 240;         // Frames in the graph and the percentiles
+    static const Uint32 TEXT_REFRESH_MS = 250;
+
+    ProfilerOverlay(SDL_Renderer* renderer, const TextureAtlas* atlas);
+    ProfilerOverlay(const ProfilerOverlay&) = delete;
+    ProfilerOverlay& operator=(const ProfilerOverlay&) = delete;
+
+    void toggle() { visible = !visible; }
+    bool isVisible() const { return visible; }
+    void render();
+
+private:
+    void refreshText();
+
+    SDL_Renderer* renderer;
+    TextRenderer text;
+    bool visible;
+    Uint32 lastRefresh;
+    std::vector<std::string> lines;
+    std::vector<SDL_Rect> bars[3]; // Within budget, over budget, over twice the budget
+};
+
+#endif
@@ -0,0 +1,215 @@
+#include "TextRenderer.h"
+#include <algorithm>
+#include <iostream>
+
+static std::string glyphPrefix(int fontSize) {
+    return "glyph/" + std::to_string(fontSize) + "/";
+}
+
+bool TextRenderer::LayoutKey::operator<(const LayoutKey& other) const {
+    if (fontSize != other.fontSize) return fontSize < other.fontSize;
+    if (color != other.color) return color < other.color;
+    return text < other.text;
+}
+
+TextRenderer::TextRenderer(SDL_Renderer* renderer, const TextureAtlas* atlas, const char* fontPath)
+    : renderer(renderer), atlas(atlas), fontPath(fontPath), useCounter(0) {
+}
+
+TextRenderer::~TextRenderer() {
+    clearLayouts();
+    for (auto& entry : faces) {
+        if (entry.second.font) {
+            TTF_CloseFont(entry.second.font);
+        }
+    }
+}
+
+void TextRenderer::addGlyphs(TextureAtlas& atlas, const char* fontPath, int fontSize) {
+    TTF_Font* font = TTF_OpenFont(fontPath, fontSize);
+    if (font == nullptr) {
+        std::cerr << "Failed to load font: " << TTF_GetError() << std::endl;
+        return;
+    }
+    atlas.addGlyphs(glyphPrefix(fontSize), font, ' ', '~');
+    TTF_CloseFont(font);
+}
+
+TextRenderer::Face& TextRenderer::getFace(int fontSize) {
+    auto it = faces.find(fontSize);
+    if (it != faces.end()) return it->second;
+
+    Face& face = faces[fontSize];
+    face.font = TTF_OpenFont(fontPath.c_str(), fontSize);
+    if (face.font == nullptr) {
+        std::cerr << "Failed to load font: " << TTF_GetError() << std::endl;
+    }
+    face.height = face.font ? TTF_FontHeight(face.font) : 0;
+
+    // Look the glyphs up once rather than by name for every character drawn
+    std::string prefix = glyphPrefix(fontSize);
+    for (int c = 0; c < 128; ++c) {
+        face.advance[c] = -1;
+        face.glyphs[c] = atlas && c >= ' ' ? atlas->find(prefix + static_cast<char>(c)) : nullptr;
+    }
+    return face;
+}
+
+int TextRenderer::advanceOf(Face& face, unsigned char c) {
+    if (face.advance[c] < 0) {
+        int minX, maxX, minY, maxY, advance;
+        if (!face.font || TTF_GlyphMetrics(face.font, c, &minX, &maxX, &minY, &maxY, &advance) != 0) {
+            advance = 0;
+        }
+        face.advance[c] = advance;
+    }
+    return face.advance[c];
+}
+
+void TextRenderer::measure(const std::string& text, int fontSize, int& width, int& height) {
+    Face& face = getFace(fontSize);
+    width = 0;
+    height = face.height;
+    for (char c : text) {
+        unsigned char index = static_cast<unsigned char>(c);
+        if (index >= 128) {
+            // Multi-byte UTF-8 has no cached metrics; let SDL_ttf measure it
+            if (!face.font || TTF_SizeUTF8(face.font, text.c_str(), &width, &height) != 0) {
+                width = 0;
+            }
+            return;
+        }
+        width += advanceOf(face, index);
+    }
+}
+
+TextRenderer::Layout& TextRenderer::getLayout(const std::string& text, int fontSize, SDL_Color color) {
+    LayoutKey key = {fontSize, (Uint32(color.r) << 24) | (color.g << 16) | (color.b << 8) | color.a, text};
+    auto it = layouts.find(key);
+    if (it == layouts.end()) {
+        if (layouts.size() >= static_cast<size_t>(MAX_LAYOUTS)) {
+            auto oldest = layouts.begin();
+            for (auto candidate = layouts.begin(); candidate != layouts.end(); ++candidate) {
+                if (candidate->second.lastUse < oldest->second.lastUse) oldest = candidate;
+            }
+            freeLayout(oldest->second);
+            layouts.erase(oldest);
+        }
+        it = layouts.insert(std::make_pair(key, Layout())).first;
+        buildLayout(it->second, text, getFace(fontSize), color);
+    }
+    it->second.lastUse = ++useCounter;
+    return it->second;
+}
+
+void TextRenderer::buildLayout(Layout& layout, const std::string& text, Face& face, SDL_Color color) {
+    layout.width = 0;
+    layout.height = face.height;
+    layout.page = nullptr;
+    layout.x = 0;
+    layout.y = 0;
+    layout.texture = nullptr;
+    layout.lastUse = 0;
+
+    // Glyphs from one atlas page, each placed at the pen and advanced by its metrics
+    bool fromAtlas = true;
+    for (char c : text) {
+        unsigned char index = static_cast<unsigned char>(c);
+        if (index == ' ') {
+            layout.width += advanceOf(face, index); // Nothing to draw
+            continue;
+        }
+        const TextureAtlas::Region* glyph = index < 128 ? face.glyphs[index] : nullptr;
+        if (!glyph || (layout.page && glyph->texture != layout.page)) {
+            fromAtlas = false;
+            break;
+        }
+        layout.page = glyph->texture;
+        SDL_Rect quad = {layout.width, 0, glyph->rect.w, glyph->rect.h};
+        layout.sources.push_back(glyph->rect);
+        layout.quads.push_back(quad);
+        layout.width += advanceOf(face, index);
+    }
+    if (fromAtlas) return;
+
+    layout.sources.clear();
+    layout.quads.clear();
+    layout.page = nullptr;
+    layout.width = 0;
+    if (!face.font || text.empty()) return;
+
+    SDL_Surface* surface = TTF_RenderUTF8_Blended(face.font, text.c_str(), color);
+    if (surface == nullptr) {
+        std::cerr << "Failed to create text surface: " << TTF_GetError() << std::endl;
+        return;
+    }
+    layout.texture = SDL_CreateTextureFromSurface(renderer, surface);
+    if (layout.texture == nullptr) {
+        std::cerr << "Failed to create text texture: " << SDL_GetError() << std::endl;
+    }
+    layout.width = surface->w;
+    layout.height = surface->h;
+    SDL_FreeSurface(surface);
+}
+
+// Batches the layout's glyphs drawn at (x, y); they are kept until it moves.
+// False if geometry is unavailable
+bool TextRenderer::place(Layout& layout, int x, int y, SDL_Color color) {
+    if (!layout.batch.isEmpty() && layout.x == x && layout.y == y) return true;
+    layout.x = x;
+    layout.y = y;
+    if (!layout.batch.begin(renderer, layout.page)) return false;
+
+    for (size_t i = 0; i < layout.quads.size(); ++i) {
+        const SDL_Rect& quad = layout.quads[i];
+        SDL_Rect dest = {x + quad.x, y + quad.y, quad.w, quad.h};
+        layout.batch.add(layout.sources[i], dest, color);
+    }
+    return true;
+}
+
+void TextRenderer::draw(const std::string& text, int fontSize, int x, int y, SDL_Color color) {
+    if (text.empty()) return;
+    drawLayout(getLayout(text, fontSize, color), x, y, color);
+}
+
+void TextRenderer::drawCentered(const std::string& text, int fontSize, const SDL_Rect& box, SDL_Color color) {
+    if (text.empty()) return;
+    Layout& layout = getLayout(text, fontSize, color);
+    drawLayout(layout, box.x + (box.w - layout.width) / 2, box.y + (box.h - layout.height) / 2, color);
+}
+
+void TextRenderer::drawLayout(Layout& layout, int x, int y, SDL_Color color) {
+    if (layout.texture) {
+        SDL_Rect renderQuad = {x, y, layout.width, layout.height};
+        SDL_RenderCopy(renderer, layout.texture, nullptr, &renderQuad);
+        return;
+    }
+    if (!layout.page || layout.quads.empty()) return;
+
+    if (place(layout, x, y, color) && layout.batch.draw() >= 0) {
+        return;
+    }
+
+    // Tint the shared page for this string only
+    SDL_SetTextureColorMod(layout.page, color.r, color.g, color.b);
+    for (size_t i = 0; i < layout.quads.size(); ++i) {
+        SDL_Rect renderQuad = {x + layout.quads[i].x, y + layout.quads[i].y, layout.quads[i].w, layout.quads[i].h};
+        SDL_RenderCopy(renderer, layout.page, &layout.sources[i], &renderQuad);
+    }
+    SDL_SetTextureColorMod(layout.page, 255, 255, 255);
+}
+
+void TextRenderer::clearLayouts() {
+    for (auto& entry : layouts) {
+        freeLayout(entry.second);
+    }
+    layouts.clear();
+}
+
+void TextRenderer::freeLayout(Layout& layout) {
+    if (layout.texture) {
+        SDL_DestroyTexture(layout.texture);
+        layout.texture = nullptr;
+    }
+}
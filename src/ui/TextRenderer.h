@@ -0,0 +1,81 @@
+#ifndef TEXTRENDERER_H
+#define TEXTRENDERER_H
+
+#include <SDL.h>
+#include <SDL_ttf.h>
+#include <map>
+#include <string>
+#include <vector>
+#include "TextureAtlas.h"
+#include "TileBatch.h"
+
+// Draws UI text from glyphs packed into the texture atlas. Each font size is
+// opened once and its glyph metrics are read once; laid-out strings are
+// cached by content, size and color, so text that has not changed is a
+// single SDL_RenderGeometry call. Text the atlas cannot spell (other sizes,
+// non-ASCII input) is rendered by SDL_ttf into a texture once and cached the
+// same way.
+class TextRenderer {
+public:
+    static const int MAX_LAYOUTS = 64; // Cached strings before the least recently drawn goes
+
+    TextRenderer(SDL_Renderer* renderer, const TextureAtlas* atlas, const char* fontPath);
+    ~TextRenderer();
+    TextRenderer(const TextRenderer&) = delete;
+    TextRenderer& operator=(const TextRenderer&) = delete;
+
+    // Queues the printable ASCII glyphs of a font size as regions "glyph/<size>/<character>"
+    static void addGlyphs(TextureAtlas& atlas, const char* fontPath, int fontSize);
+
+    // Size `text` would take, from the cached metrics
+    void measure(const std::string& text, int fontSize, int& width, int& height);
+    // Draws `text` with its top-left corner at (x, y)
+    void draw(const std::string& text, int fontSize, int x, int y, SDL_Color color);
+    // Draws `text` centered within `box`
+    void drawCentered(const std::string& text, int fontSize, const SDL_Rect& box, SDL_Color color);
+    // Drops every cached layout, e.g. after the render targets were reset
+    void clearLayouts();
+
+private:
+    struct Face {
+        TTF_Font* font;    // Null if the size failed to load; it is not retried
+        int height;
+        int advance[128];  // -1 until read from the font
+        const TextureAtlas::Region* glyphs[128];
+    };
+
+    struct LayoutKey {
+        int fontSize;
+        Uint32 color;
+        std::string text;
+        bool operator<(const LayoutKey& other) const;
+    };
+
+    struct Layout {
+        int width, height;
+        SDL_Texture* page;               // Atlas page the glyphs come from
+        std::vector<SDL_Rect> sources;   // Glyph rects in the page
+        std::vector<SDL_Rect> quads;     // Where each glyph lands, relative to the origin
+        TileBatch batch;                 // Quads placed at (x, y), ready to submit
+        int x, y;
+        SDL_Texture* texture; // Whole string from SDL_ttf when the atlas lacks a glyph
+        unsigned int lastUse;
+    };
+
+    Face& getFace(int fontSize);
+    int advanceOf(Face& face, unsigned char c);
+    Layout& getLayout(const std::string& text, int fontSize, SDL_Color color);
+    void buildLayout(Layout& layout, const std::string& text, Face& face, SDL_Color color);
+    bool place(Layout& layout, int x, int y, SDL_Color color);
+    void drawLayout(Layout& layout, int x, int y, SDL_Color color);
+    static void freeLayout(Layout& layout);
+
+    SDL_Renderer* renderer;
+    const TextureAtlas* atlas;
+    std::string fontPath;
+    std::map<int, Face> faces;
+    std::map<LayoutKey, Layout> layouts;
+    unsigned int useCounter;
+};
+
+#endif
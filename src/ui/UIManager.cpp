@@ -4,25 +4,24 @@
 #include <string>
 #include <iostream>
 
-UIManager::UIManager(SDL_Renderer* renderer, int windowWidth, int windowHeight)
+UIManager::UIManager(SDL_Renderer* renderer, int windowWidth, int windowHeight, const TextureAtlas* atlas)
     : renderer(renderer), windowWidth(windowWidth), windowHeight(windowHeight), 
-      isInputActive(false), caretPosition(0), caretVisible(true), lastCaretToggle(SDL_GetTicks()) {
-    
-    // Load the font once here
-    font = TTF_OpenFont(ROOT_PATH "assets/Fixedsys.ttf", 24);
-
-    // Initialize the layout
-    updateLayout();
+      isInputActive(false), caretPosition(0), caretVisible(true), lastCaretToggle(SDL_GetTicks()),
+      dirty(true), text(renderer, atlas, ROOT_PATH "assets/Fixedsys.ttf") {
 
     // Initialize seed text with a random value
     unsigned int initialSeed = static_cast<unsigned int>(time(nullptr));
     seedText = std::to_string(initialSeed);
+
+    // Initialize the layout
+    updateLayout();
 }
 
 UIManager::~UIManager() {
-    if (font) {
-        TTF_CloseFont(font);
-    }
+}
+
+void UIManager::addToAtlas(TextureAtlas& atlas) {
+    TextRenderer::addGlyphs(atlas, ROOT_PATH "assets/Fixedsys.ttf", FONT_SIZE);
 }
 
 void UIManager::updateLayout() {
@@ -35,6 +34,8 @@ void UIManager::updateLayout() {
     inputField.y = playButton.y + 60; // 10px below the play button
     inputField.w = 100;
     inputField.h = 30;
+    adjustInputFieldSize();
+    dirty = true;
 }
 
 void UIManager::handleEvents(SDL_Event& event) {
@@ -43,6 +44,7 @@ void UIManager::handleEvents(SDL_Event& event) {
     if (event.type == SDL_MOUSEBUTTONDOWN) {
         int x = event.button.x;
         int y = event.button.y;
+        dirty = true;
 
         // Check if click is inside the input field
         if (x >= inputField.x && x <= inputField.x + inputField.w &&
@@ -62,6 +64,7 @@ void UIManager::handleEvents(SDL_Event& event) {
             seedText.insert(caretPosition, event.text.text);
             caretPosition += strlen(event.text.text);
             adjustInputFieldSize();
+            dirty = true;
         } else {
             handleKeyboardInput(event);
         }
@@ -81,9 +84,7 @@ void UIManager::render() {
     SDL_RenderFillRect(renderer, &playButtonInnerRect);
 
     SDL_Rect playButtonTextRect = {playButton.x, playButton.y, playButton.w, playButton.h};
-    renderText("Play", ROOT_PATH "assets/Fixedsys.ttf", 24, playButtonTextRect, {0, 0, 0, 255});
-
-    adjustInputFieldSize();
+    text.drawCentered("Play", FONT_SIZE, playButtonTextRect, {0, 0, 0, 255});
 
     SDL_Rect inputFieldRect = {inputField.x, inputField.y, inputField.w, inputField.h};
     SDL_SetRenderDrawColor(renderer, 130, 130, 130, 255);
@@ -94,12 +95,12 @@ void UIManager::render() {
     SDL_RenderFillRect(renderer, &inputFieldInnerRect);
 
     SDL_Rect seedTextBox = {inputField.x + 10, inputField.y + 5, inputField.w - 20, inputField.h - 10};
-    renderText(seedText, ROOT_PATH "assets/Fixedsys.ttf", 24, seedTextBox, {0, 0, 0, 255});
+    text.drawCentered(seedText, FONT_SIZE, seedTextBox, {0, 0, 0, 255});
 
     if (isInputActive && caretVisible) {
         std::string textUpToCaret = seedText.substr(0, caretPosition);
         int caretX, textHeight;
-        TTF_SizeText(font, textUpToCaret.c_str(), &caretX, &textHeight);
+        text.measure(textUpToCaret, FONT_SIZE, caretX, textHeight);
         caretX += inputField.x + 10;
 
         SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
@@ -107,6 +108,7 @@ void UIManager::render() {
     }
 
     SDL_RenderPresent(renderer);
+    dirty = false;
 }
 
 void UIManager::handleWindowSizeChange(int newWidth, int newHeight) {
@@ -125,7 +127,8 @@ int UIManager::calculateCaretPosition(int mouseX) {
 
     // Calculate the width of a single character
     int charWidth, charHeight;
-    TTF_SizeText(font, "A", &charWidth, &charHeight); // Use a representative character
+    text.measure("A", FONT_SIZE, charWidth, charHeight); // Use a representative character
+    if (charWidth <= 0) return 0;
 
     // Calculate relative position of the click from the start of the text
     int relativeX = mouseX - startX;
@@ -142,7 +145,7 @@ int UIManager::calculateCaretPosition(int mouseX) {
 
 void UIManager::adjustInputFieldSize() {
     int textWidth, textHeight;
-    TTF_SizeText(font, seedText.c_str(), &textWidth, &textHeight);
+    text.measure(seedText, FONT_SIZE, textWidth, textHeight);
 
     // Update input field width to fit the text, with some padding
     inputField.w = std::max(100, textWidth + 20); // Minimum width is 100
@@ -156,41 +159,22 @@ void UIManager::updateCaretVisibility() {
     if (currentTime - lastCaretToggle > caretToggleInterval) {
         caretVisible = !caretVisible;
         lastCaretToggle = currentTime;
+        // The caret is only drawn in the active field
+        if (isInputActive) {
+            dirty = true;
+        }
     }
 }
 
-void UIManager::renderText(const std::string& text, const std::string& fontPath, int fontSize, SDL_Rect boundingBox, SDL_Color color) {
-    TTF_Font* font = TTF_OpenFont(fontPath.c_str(), fontSize);
-    if (font == nullptr) {
-        std::cerr << "Failed to load font: " << TTF_GetError() << std::endl;
-        return;
-    }
-
-    SDL_Surface* surface = TTF_RenderText_Solid(font, text.c_str(), color);
-    if (surface == nullptr) {
-        TTF_CloseFont(font);
-        std::cerr << "Failed to create text surface: " << TTF_GetError() << std::endl;
-        return;
-    }
-
-    // Center the text within the bounding box
-    int textX = boundingBox.x + (boundingBox.w - surface->w) / 2;
-    int textY = boundingBox.y + (boundingBox.h - surface->h) / 2;
-
-    SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, surface);
-    if (texture == nullptr) {
-        SDL_FreeSurface(surface);
-        TTF_CloseFont(font);
-        std::cerr << "Failed to create text texture: " << SDL_GetError() << std::endl;
-        return;
-    }
-
-    SDL_Rect renderQuad = {textX, textY, surface->w, surface->h};
-    SDL_RenderCopy(renderer, texture, nullptr, &renderQuad);
+void UIManager::update() {
+    updateCaretVisibility();
+}
 
-    SDL_DestroyTexture(texture);
-    SDL_FreeSurface(surface);
-    TTF_CloseFont(font);
+int UIManager::getIdleTimeout() const {
+    if (!isInputActive) return -1;
+    // The caret toggles once more than the interval has passed
+    Uint32 elapsed = SDL_GetTicks() - lastCaretToggle;
+    return elapsed > static_cast<Uint32>(caretToggleInterval) ? 0 : caretToggleInterval + 1 - static_cast<int>(elapsed);
 }
 
 void UIManager::handleKeyboardInput(const SDL_Event& event) {
@@ -205,7 +189,10 @@ void UIManager::handleKeyboardInput(const SDL_Event& event) {
         caretPosition--;
     } else if (event.key.keysym.sym == SDLK_RIGHT && caretPosition < static_cast<int>(seedText.length())) {
         caretPosition++;
+    } else {
+        return;
     }
+    dirty = true;
 }
 
 bool UIManager::isPlayButtonClicked(int x, int y) const {
@@ -4,17 +4,31 @@
 #include <SDL.h>
 #include <string>
 #include <SDL_ttf.h>
+#include "TextureAtlas.h"
+#include "TextRenderer.h"
 
 class UIManager {
 public:
-    UIManager(SDL_Renderer* renderer, int windowWidth, int windowHeight);
+    static const int FONT_SIZE = 24;
+
+    // Text is drawn from the atlas glyphs when `atlas` has them
+    UIManager(SDL_Renderer* renderer, int windowWidth, int windowHeight, const TextureAtlas* atlas = nullptr);
     ~UIManager();
+    // Queues the printable ASCII glyphs of the UI font as regions "glyph/<size>/<character>"
+    static void addToAtlas(TextureAtlas& atlas);
     void handleEvents(SDL_Event& event);
     void render();
     void handleWindowSizeChange(int newWidth, int newHeight);
     std::string getSeedText() const;
     void updateLayout();
     bool isPlayButtonClicked(int x, int y) const;
+    // Something changed since the last render(), or the caret blinked
+    bool needsRedraw() const { return dirty; }
+    void invalidate() { dirty = true; }
+    // Advances the caret blink
+    void update();
+    // Milliseconds until the screen changes on its own, or -1 if it will not
+    int getIdleTimeout() const;
 
 private:
     SDL_Renderer* renderer;
@@ -25,13 +39,13 @@ private:
     int windowWidth; // Current width of the window
     int windowHeight; // Current height of the window
     void adjustInputFieldSize(); // Adjust the size of the input field
-    void renderText(const std::string& text, const std::string& fontPath, int fontSize, SDL_Rect boundingBox, SDL_Color color);
     int caretPosition; // Position of the caret in the seed text
     bool caretVisible; // Whether the caret is currently visible
     Uint32 lastCaretToggle; // Time since the last caret toggle
     const int caretToggleInterval = 500; // Caret blink interval in milliseconds
     void updateCaretVisibility();
-    TTF_Font* font;
+    bool dirty; // The screen no longer shows the current state
+    TextRenderer text; // Owns the font; caches glyph metrics and laid-out strings
     int calculateCaretPosition(int mouseX);
     void handleKeyboardInput(const SDL_Event& event);
 };
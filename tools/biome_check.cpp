@@ -0,0 +1,76 @@
+// Compares coarse biome sampling against exact per-tile sampling: generates
+// the same square of chunks with both and reports how many tiles end up with
+// a different type, and what each mode costs per chunk.
+//
+// usage: biome_check [seed] [radius in chunks] [biome step]
+// Without a step, steps 2, 4, 8 and 16 are compared in turn; a given step
+// must be 2 or more.
+#define SDL_MAIN_HANDLED
+#include "ChunkGenerator.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+static double generateAll(ChunkGenerator& generator, int radius, std::vector<Chunk>& chunks) {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    int i = 0;
+    for (int chunkY = -radius; chunkY < radius; ++chunkY) {
+        for (int chunkX = -radius; chunkX < radius; ++chunkX, ++i) {
+            generator.generate(chunkX, chunkY, chunks[i]);
+        }
+    }
+    std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / chunks.size();
+}
+
+int main(int argc, char* argv[]) {
+    unsigned int seed = argc > 1 ? static_cast<unsigned int>(strtoul(argv[1], nullptr, 10)) : 12345;
+    int radius = argc > 2 ? atoi(argv[2]) : 8;
+    if (radius < 1) radius = 1;
+
+    std::vector<int> steps = {2, 4, 8, 16};
+    if (argc > 3) {
+        int step = atoi(argv[3]);
+        if (step < 2) {
+            fprintf(stderr, "usage: %s [seed] [radius in chunks] [biome step of 2 or more]\n", argv[0]);
+            return 2;
+        }
+        steps.assign(1, step);
+    }
+
+    int chunkCount = 4 * radius * radius;
+    std::vector<Chunk> exact(chunkCount), coarse(chunkCount);
+
+    ChunkGenerator exactGenerator(seed, 1);
+    double exactMicros = generateAll(exactGenerator, radius, exact);
+    printf("seed %u, %d chunks of %dx%d tiles\n", seed, chunkCount, Chunk::SIZE, Chunk::SIZE);
+    printf("step  1: exact, %.1f us/chunk\n", exactMicros);
+
+    for (int step : steps) {
+        ChunkGenerator coarseGenerator(seed, step);
+        double coarseMicros = generateAll(coarseGenerator, radius, coarse);
+
+        long long changed = 0;
+        long long changedBy[TILE_TYPE_COUNT] = {};
+        for (int i = 0; i < chunkCount; ++i) {
+            for (int t = 0; t < Chunk::AREA; ++t) {
+                if (exact[i].tiles[t] != coarse[i].tiles[t]) {
+                    ++changed;
+                    ++changedBy[exact[i].tiles[t]];
+                }
+            }
+        }
+
+        long long total = static_cast<long long>(chunkCount) * Chunk::AREA;
+        printf("step %2d: %lld of %lld tiles changed (%.3f%%), %.1f us/chunk (%.0f%% of exact)",
+               step, changed, total, 100.0 * changed / total, coarseMicros, 100.0 * coarseMicros / exactMicros);
+        for (int type = 0; type < TILE_TYPE_COUNT; ++type) {
+            if (changedBy[type]) {
+                printf(", %s %lld", Tile::getName(static_cast<TileType>(type)), changedBy[type]);
+            }
+        }
+        printf("\n");
+    }
+    return 0;
+}
@@ -0,0 +1,300 @@
+// Headless benchmark of the real game loop. Runs Game, Map and Player under
+// SDL's dummy video driver and software renderer, skips the title screen and
+// drives the player along scripted paths from a fixed seed. Every frame
+// advances exactly one simulation tick, so each run covers the same ground
+// however fast the machine is. Chunks are always generated, never read from
+// saved regions.
+//
+// Results are written as JSON. Given a baseline (the JSON of an earlier run),
+// any metric that got worse by more than its threshold is reported and the
+// exit code is 1. A baseline may carry a "thresholds" object of metric name
+// to allowed fraction, overriding --threshold for that metric.
+//
+// Heap allocations made through C++ operator new, on any thread, are counted
+// over the second half of each path, once the chunk pool and the caches have
+// warmed up; against a baseline of none, any allocation is a regression.
+// SDL's own mallocs are not seen. Chunk pool allocations over the same half
+// are compared the same way; pool reuses are reported for information only.
+//
+// usage: game_bench [--frames N] [--path NAME] [--output FILE] [--baseline FILE] [--threshold FRACTION]
+// Paths: sprint, spiral, random_walk, teleport; all of them by default.
+#define SDL_MAIN_HANDLED
+#include "tool_support.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+using json = nlohmann::json;
+
+// Every operator new of the process goes through here so runScript can count them
+static std::atomic<long long> heapAllocations(0);
+
+void* operator new(std::size_t size) {
+    heapAllocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* memory = malloc(size ? size : 1)) return memory;
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void* memory) noexcept {
+    free(memory);
+}
+
+void operator delete[](void* memory) noexcept {
+    free(memory);
+}
+
+static const unsigned int BENCH_SEED = 12345;
+static const int START_X = 100;
+static const int START_Y = 100;
+
+// A number in [low, high] from the raw generator. mt19937's output is fixed
+// by the standard but std::uniform_int_distribution's mapping is not, and
+// each draw is its own statement because argument evaluation order is
+// unspecified; either would give each compiler its own paths
+static int randomIn(std::mt19937& random, int low, int high) {
+    return low + static_cast<int>(random() % static_cast<Uint32>(high - low + 1));
+}
+
+static void move(Player& player, int dx, int dy) {
+    player.setMovingLeft(dx < 0);
+    player.setMovingRight(dx > 0);
+    player.setMovingUp(dy < 0);
+    player.setMovingDown(dy > 0);
+}
+
+// Flat out in one direction: streaming has to keep up with the view
+static void sprint(Player& player, int frame, std::mt19937& random) {
+    (void)frame; (void)random;
+    move(player, 1, 0);
+}
+
+// Right, down, left, up with legs growing every other turn, so the path keeps
+// crossing chunks it loaded a while ago
+static void spiral(Player& player, int frame, std::mt19937& random) {
+    (void)random;
+    static const int dx[4] = {1, 0, -1, 0};
+    static const int dy[4] = {0, 1, 0, -1};
+    int leg = 0;
+    int length = 30;
+    while (frame >= length) {
+        frame -= length;
+        ++leg;
+        length = 30 * (leg / 2 + 1);
+    }
+    move(player, dx[leg % 4], dy[leg % 4]);
+}
+
+// A new direction (or a pause) every half second
+static void randomWalk(Player& player, int frame, std::mt19937& random) {
+    if (frame % 30 != 0) return;
+    int dx = randomIn(random, -1, 1);
+    int dy = randomIn(random, -1, 1);
+    move(player, dx, dy);
+}
+
+// Jumps to unvisited ground every second, where nothing is loaded or cached
+static void teleport(Player& player, int frame, std::mt19937& random) {
+    if (frame % 60 == 0) {
+        const int range = 64 * Chunk::SIZE * Tile::SIZE;
+        int dx = randomIn(random, -range, range);
+        int dy = randomIn(random, -range, range);
+        player.setPosition(START_X + dx, START_Y + dy);
+    }
+    move(player, 1, 1);
+}
+
+struct Script {
+    const char* name;
+    void (*drive)(Player& player, int frame, std::mt19937& random);
+    float speed; // Pixels per second
+};
+
+static const Script scripts[] = {
+    {"sprint", sprint, 1200.0f},
+    {"spiral", spiral, 600.0f},
+    {"random_walk", randomWalk, 300.0f},
+    {"teleport", teleport, 300.0f},
+};
+
+// Kilobytes, or 0 where the platform does not say
+static long long peakRssKb() {
+#ifndef _WIN32
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+#ifdef __APPLE__
+    return usage.ru_maxrss / 1024; // Bytes on macOS
+#else
+    return usage.ru_maxrss;
+#endif
+#else
+    return 0;
+#endif
+}
+
+static json runScript(Game& game, const Script& script, int frames) {
+    Map& map = game.getMap();
+    Player& player = game.getPlayer();
+    game.setSeed(BENCH_SEED);
+    player.setPosition(START_X, START_Y);
+    player.setWalkSpeed(script.speed);
+    move(player, 0, 0);
+    std::mt19937 random(BENCH_SEED);
+
+    long long generatedBefore = map.getGeneratedChunkCount();
+    Map::PrefetchStats prefetchBefore = map.getPrefetchStats();
+    std::vector<double> frameMs;
+    frameMs.reserve(frames);
+    int peakLoaded = 0;
+    long long drawCalls = 0;
+    ChunkPool::Stats poolAtHalf = map.getChunkPoolStats();
+    long long allocationsAtHalf = heapAllocations.load();
+
+    Uint64 frequency = SDL_GetPerformanceFrequency();
+    Uint64 start = SDL_GetPerformanceCounter();
+    for (int frame = 0; frame < frames; ++frame) {
+        if (frame == frames / 2) {
+            poolAtHalf = map.getChunkPoolStats();
+            allocationsAtHalf = heapAllocations.load();
+        }
+        Uint64 frameStart = SDL_GetPerformanceCounter();
+        script.drive(player, frame, random);
+        game.handleEvents();
+        game.step(1);
+        game.render();
+        frameMs.push_back((SDL_GetPerformanceCounter() - frameStart) * 1000.0 / frequency);
+
+        peakLoaded = std::max(peakLoaded, map.getLoadedChunkCount());
+        drawCalls += map.getRenderStats().drawCalls;
+    }
+    double seconds = static_cast<double>(SDL_GetPerformanceCounter() - start) / frequency;
+
+    long long allocations = heapAllocations.load() - allocationsAtHalf;
+    long long generated = map.getGeneratedChunkCount() - generatedBefore;
+    Map::PrefetchStats prefetch = map.getPrefetchStats();
+    ChunkPool::Stats pool = map.getChunkPoolStats();
+    json result;
+    result["frames"] = frames;
+    result["seconds"] = seconds;
+    result["frame_ms_p50"] = percentile(frameMs, 0.50);
+    result["frame_ms_p95"] = percentile(frameMs, 0.95);
+    result["frame_ms_p99"] = percentile(frameMs, 0.99);
+    result["frame_ms_max"] = *std::max_element(frameMs.begin(), frameMs.end());
+    result["chunks_generated"] = generated;
+    result["chunks_per_second"] = seconds > 0.0 ? generated / seconds : 0.0;
+    result["peak_loaded_chunks"] = peakLoaded;
+    result["draw_calls_per_frame"] = static_cast<double>(drawCalls) / frames;
+    result["prefetch_hits"] = prefetch.hits - prefetchBefore.hits;
+    result["prefetch_misses"] = prefetch.misses - prefetchBefore.misses;
+    result["heap_allocations_steady"] = allocations;
+    result["pool_allocations_steady"] = pool.allocations - poolAtHalf.allocations;
+    result["pool_reuses_steady"] = pool.reuses - poolAtHalf.reuses;
+    return result;
+}
+
+// Metrics compared against a baseline, and whether a larger value is worse
+struct Metric {
+    const char* name;
+    bool higherIsWorse;
+};
+
+static const Metric metrics[] = {
+    {"frame_ms_p50", true},
+    {"frame_ms_p95", true},
+    {"frame_ms_p99", true},
+    {"chunks_per_second", false},
+    {"peak_loaded_chunks", true},
+    {"heap_allocations_steady", true},
+    {"pool_allocations_steady", true},
+};
+
+// Prints every regression beyond its threshold; returns how many there were
+static int compare(const json& results, const json& baseline, double defaultThreshold) {
+    json thresholds = baseline.value("thresholds", json::object());
+    int regressions = 0;
+    auto check = [&](const std::string& where, const char* name, bool higherIsWorse, double value, double reference) {
+        if (compareMetric(where.c_str(), name, reference, value, higherIsWorse, thresholds.value(name, defaultThreshold))) {
+            ++regressions;
+        }
+    };
+
+    for (auto& path : results["paths"].items()) {
+        if (!baseline["paths"].contains(path.key())) continue;
+        const json& reference = baseline["paths"][path.key()];
+        for (const Metric& metric : metrics) {
+            if (!reference.contains(metric.name)) continue;
+            check(path.key(), metric.name, metric.higherIsWorse, path.value()[metric.name].get<double>(),
+                  reference[metric.name].get<double>());
+        }
+    }
+    if (baseline.contains("peak_rss_kb") && results["peak_rss_kb"].get<long long>() > 0) {
+        check("all", "peak_rss_kb", true, results["peak_rss_kb"].get<double>(), baseline["peak_rss_kb"].get<double>());
+    }
+    return regressions;
+}
+
+int main(int argc, char* argv[]) {
+    int frames = 600;
+    const char* onlyPath = nullptr;
+    const char* outputPath = "game_bench.json";
+    const char* baselinePath = nullptr;
+    double threshold = 0.10;
+    for (int i = 1; i < argc; ++i) {
+        bool hasValue = i + 1 < argc;
+        if (!strcmp(argv[i], "--frames") && hasValue) frames = std::max(1, atoi(argv[++i]));
+        else if (!strcmp(argv[i], "--path") && hasValue) onlyPath = argv[++i];
+        else if (!strcmp(argv[i], "--output") && hasValue) outputPath = argv[++i];
+        else if (!strcmp(argv[i], "--baseline") && hasValue) baselinePath = argv[++i];
+        else if (!strcmp(argv[i], "--threshold") && hasValue) threshold = atof(argv[++i]);
+        else {
+            fprintf(stderr, "usage: %s [--frames N] [--path NAME] [--output FILE] [--baseline FILE] [--threshold FRACTION]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    Game game;
+    if (!startGame(game, "game_bench", false)) {
+        return 2;
+    }
+
+    json results;
+    results["seed"] = BENCH_SEED;
+    results["chunk_size"] = static_cast<int>(Chunk::SIZE); // A copy; json would bind the constant by reference
+    results["paths"] = json::object();
+    for (const Script& script : scripts) {
+        if (onlyPath && strcmp(onlyPath, script.name) != 0) continue;
+        json result = runScript(game, script, frames);
+        printf("%-12s p50 %.2f ms  p99 %.2f ms  %.0f chunks/s  peak %d chunks  %lld steady allocations\n", script.name,
+               result["frame_ms_p50"].get<double>(), result["frame_ms_p99"].get<double>(),
+               result["chunks_per_second"].get<double>(), result["peak_loaded_chunks"].get<int>(),
+               result["heap_allocations_steady"].get<long long>());
+        results["paths"][script.name] = result;
+    }
+    results["peak_rss_kb"] = peakRssKb();
+    game.clean();
+
+    if (!writeResults(outputPath, results)) {
+        return 2;
+    }
+
+    if (!baselinePath) return 0;
+    json baseline;
+    if (!readBaseline(baselinePath, "paths", baseline)) {
+        return 2;
+    }
+    int regressions = compare(results, baseline, threshold);
+    printf("%d regression%s against %s\n", regressions, regressions == 1 ? "" : "s", baselinePath);
+    return regressions > 0 ? 1 : 0;
+}
@@ -0,0 +1,318 @@
+// Microbenchmarks of the world-generation and map hot paths, each timed in
+// isolation. Every benchmark is warmed up, calibrated so one sample takes
+// about SAMPLE_MS, then sampled repeatedly; the table shows nanoseconds per
+// operation as min, median and mean, and the spread as the coefficient of
+// variation. Compare medians between builds; a high CV means the machine was
+// busy and the numbers should be taken again.
+//
+// usage: microbench [--filter TEXT] [--samples N]
+#define SDL_MAIN_HANDLED
+#include "Map.h"
+#include "ChunkGenerator.h"
+#include "RegionStore.h"
+#include "NoiseBatch.h"
+#include "FastNoiseLite.h"
+#include <SDL_image.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+static const unsigned int SEED = 12345;
+static const double WARMUP_MS = 100.0;
+static const double SAMPLE_MS = 10.0;
+
+static const char* filter = nullptr;
+static int sampleCount = 15;
+static volatile Uint32 sink; // Results go here so the work cannot be optimized away
+
+typedef std::chrono::steady_clock Clock;
+
+// Nanoseconds taken by `iterations` operations
+template <typename Body>
+static double timeRun(Body& body, long long iterations) {
+    Clock::time_point start = Clock::now();
+    body(iterations);
+    return std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+}
+
+static bool isSelected(const char* name) {
+    return !filter || strstr(name, filter);
+}
+
+// A folder for files a benchmark writes, under the system's temporary folder
+static std::string temporaryDirectory(const char* name) {
+    const char* base = getenv("TMPDIR");
+    if (!base) base = getenv("TEMP");
+    if (!base) base = "/tmp";
+    return std::string(base) + "/" + name + "." + std::to_string(SDL_GetPerformanceCounter());
+}
+
+// `body(n)` performs n operations of whatever is measured
+template <typename Body>
+static void bench(const char* name, Body body) {
+    if (!isSelected(name)) return;
+
+    // Warm up while doubling the batch until one sample is long enough to time
+    long long iterations = 1;
+    double warmedNs = 0.0;
+    while (true) {
+        double ns = timeRun(body, iterations);
+        warmedNs += ns;
+        if (ns >= SAMPLE_MS * 1e6) break;
+        iterations = ns > 0.0 ? std::max(iterations * 2, static_cast<long long>(iterations * SAMPLE_MS * 1e6 / ns))
+                              : iterations * 2;
+    }
+    while (warmedNs < WARMUP_MS * 1e6) {
+        warmedNs += timeRun(body, iterations);
+    }
+
+    std::vector<double> perOp(sampleCount);
+    for (double& sample : perOp) {
+        sample = timeRun(body, iterations) / iterations;
+    }
+    std::sort(perOp.begin(), perOp.end());
+    double mean = 0.0;
+    for (double sample : perOp) mean += sample;
+    mean /= perOp.size();
+    double variance = 0.0;
+    for (double sample : perOp) variance += (sample - mean) * (sample - mean);
+    double stddev = perOp.size() > 1 ? std::sqrt(variance / (perOp.size() - 1)) : 0.0;
+    double median = perOp.size() % 2 ? perOp[perOp.size() / 2]
+                                     : (perOp[perOp.size() / 2 - 1] + perOp[perOp.size() / 2]) / 2.0;
+
+    printf("%-36s %12.1f %12.1f %12.1f %6.1f%% %12lld\n", name, perOp.front(), median, mean,
+           mean > 0.0 ? 100.0 * stddev / mean : 0.0, iterations);
+    fflush(stdout);
+}
+
+static void benchNoise() {
+    // The fields ChunkGenerator samples, as in its constructor
+    struct Config {
+        const char* name;
+        NoiseChannel channel;
+    };
+    const Config configs[] = {
+        {"terrain", {static_cast<int>(SEED), 0.01f}},
+        {"biome", {static_cast<int>(SEED + 1), 0.01f}},
+        {"river", {static_cast<int>(SEED + 2), 0.05f}},
+        {"biome_coarse", {static_cast<int>(SEED + 1), 0.01f * ChunkGenerator::BIOME_STEP}},
+    };
+    const int side = Chunk::SIZE + 2;
+    std::vector<float> grid(side * side);
+
+    for (const Config& config : configs) {
+        FastNoiseLite noise(config.channel.seed);
+        noise.SetNoiseType(FastNoiseLite::NoiseType_Perlin);
+        noise.SetFrequency(config.channel.frequency);
+        std::string name = std::string("noise/GetNoise/") + config.name;
+        bench(name.c_str(), [&](long long n) {
+            float sum = 0.0f;
+            for (long long i = 0; i < n; ++i) {
+                sum += noise.GetNoise(static_cast<float>(i & 1023), static_cast<float>(i >> 10));
+            }
+            sink += static_cast<Uint32>(sum);
+        });
+
+        // Per point, over a padded chunk as the generator samples it
+        NoiseChannel channel = config.channel;
+        const NoiseBatch::Backend backends[] = {NoiseBatch::SCALAR, NoiseBatch::SSE2, NoiseBatch::AVX2};
+        NoiseBatch::Backend detected = NoiseBatch::getBackend();
+        for (NoiseBatch::Backend backend : backends) {
+            if (backend > detected) continue;
+            NoiseBatch::setBackend(backend);
+            name = std::string("noise/perlinGrid/") + NoiseBatch::getBackendName(backend) + "/" + config.name;
+            bench(name.c_str(), [&](long long n) {
+                for (long long done = 0; done < n; done += side * side) {
+                    NoiseBatch::perlinGrid(channel, static_cast<int>(done & 4095), 0, side, side, grid.data());
+                    sink += static_cast<Uint32>(grid[0]);
+                }
+            });
+        }
+        NoiseBatch::setBackend(detected);
+    }
+}
+
+static void benchGeneration() {
+    ChunkGenerator generator(SEED);
+    Chunk chunk;
+    chunk.tiles.resize(Chunk::AREA);
+    bench("chunk/ChunkGenerator::generate", [&](long long n) {
+        for (long long i = 0; i < n; ++i) {
+            generator.generate(static_cast<int>(i % 64), static_cast<int>(i / 64 % 64), chunk);
+            sink += chunk.tiles[0];
+        }
+    });
+
+    // The same chunks read back from region files, as a revisit would; the
+    // files stay warm in the OS cache, so this is the decode cost, not the disk's
+    if (isSelected("chunk/RegionStore::load")) {
+        std::string directory = temporaryDirectory("microbench_regions");
+        {
+            RegionStore store(directory, SEED, ChunkGenerator::VERSION);
+            for (int i = 0; i < 64 * 64; ++i) {
+                generator.generate(i % 64, i / 64, chunk);
+                store.save(SEED, i % 64, i / 64, chunk);
+            }
+            store.flush();
+            bench("chunk/RegionStore::load", [&](long long n) {
+                for (long long i = 0; i < n; ++i) {
+                    store.load(SEED, static_cast<int>(i % 64), static_cast<int>(i / 64 % 64), chunk);
+                    sink += chunk.tiles[0];
+                }
+            });
+        }
+        RegionStore::removeAll(directory);
+    }
+
+    Map map(SEED, 0);
+    bench("map/generateChunk", [&](long long n) {
+        for (long long i = 0; i < n; ++i) {
+            map.generateChunk(static_cast<int>(i % 64), static_cast<int>(i / 64 % 64), SEED);
+        }
+    });
+}
+
+static void benchLookups() {
+    // A 3x3 block of loaded chunks around the origin; lookups hit it or land far away
+    Map map(SEED, 0);
+    for (int y = -1; y <= 1; ++y) {
+        for (int x = -1; x <= 1; ++x) {
+            map.generateChunk(x, y, SEED);
+        }
+    }
+    const int count = 4096;
+    std::mt19937 random(SEED);
+    std::uniform_int_distribution<int> inside(-Chunk::SIZE, 2 * Chunk::SIZE - 1);
+    std::uniform_int_distribution<int> outside(100 * Chunk::SIZE, 200 * Chunk::SIZE);
+    std::vector<int> hitX(count), hitY(count), missX(count), missY(count);
+    for (int i = 0; i < count; ++i) {
+        hitX[i] = inside(random);
+        hitY[i] = inside(random);
+        missX[i] = outside(random);
+        missY[i] = outside(random);
+    }
+
+    bench("map/getTileAt/hit", [&](long long n) {
+        Uint32 sum = 0;
+        for (long long i = 0; i < n; ++i) {
+            sum += map.getTileAt(hitX[i & (count - 1)], hitY[i & (count - 1)]);
+        }
+        sink += sum;
+    });
+    bench("map/getTileAt/miss", [&](long long n) {
+        Uint32 sum = 0;
+        for (long long i = 0; i < n; ++i) {
+            sum += map.getTileAt(missX[i & (count - 1)], missY[i & (count - 1)]);
+        }
+        sink += sum;
+    });
+    bench("map/isChunkGenerated/hit", [&](long long n) {
+        Uint32 sum = 0;
+        for (long long i = 0; i < n; ++i) {
+            sum += map.isChunkGenerated(Chunk::chunkOf(hitX[i & (count - 1)]), Chunk::chunkOf(hitY[i & (count - 1)]));
+        }
+        sink += sum;
+    });
+    bench("map/isChunkGenerated/miss", [&](long long n) {
+        Uint32 sum = 0;
+        for (long long i = 0; i < n; ++i) {
+            sum += map.isChunkGenerated(Chunk::chunkOf(missX[i & (count - 1)]), Chunk::chunkOf(missY[i & (count - 1)]));
+        }
+        sink += sum;
+    });
+
+    // Tiles are 1-byte IDs, so "constructing" one is reading its table entry
+    bench("tile/properties", [&](long long n) {
+        Uint32 sum = 0;
+        for (long long i = 0; i < n; ++i) {
+            TileType type = static_cast<TileType>(i % TILE_TYPE_COUNT);
+            sum += Tile::getSrcRect(type).x + Tile::hasFlag(type, TILE_WATER);
+        }
+        sink += sum;
+    });
+}
+
+// Map::render in every mode into an 800x600 software target, panning a few
+// pixels per frame across a loaded 5x5 block of chunks
+static void benchRender() {
+    SDL_Surface* target = SDL_CreateRGBSurfaceWithFormat(0, 800, 600, 32, SDL_PIXELFORMAT_RGBA32);
+    SDL_Renderer* renderer = target ? SDL_CreateSoftwareRenderer(target) : nullptr;
+    if (!renderer) {
+        fprintf(stderr, "No software renderer, skipping map/render: %s\n", SDL_GetError());
+        if (target) SDL_FreeSurface(target);
+        return;
+    }
+    Tile::loadTilesetTexture(renderer, ROOT_PATH "assets/tilemap.png");
+
+    Map map(SEED, 0);
+    for (int y = -2; y <= 2; ++y) {
+        for (int x = -2; x <= 2; ++x) {
+            map.generateChunk(x, y, SEED);
+        }
+    }
+
+    struct Mode {
+        const char* name;
+        Map::RenderMode mode;
+    };
+    const Mode modes[] = {
+        {"map/render/scroll_buffer", Map::RENDER_SCROLL_BUFFER},
+        {"map/render/chunk_textures", Map::RENDER_CHUNK_TEXTURES},
+        {"map/render/tile_geometry", Map::RENDER_TILE_GEOMETRY},
+        {"map/render/tile_copies", Map::RENDER_TILE_COPIES},
+    };
+    const int span = Chunk::SIZE * Tile::SIZE; // Pans back and forth over one chunk
+    for (const Mode& mode : modes) {
+        map.setRenderMode(mode.mode);
+        long long frame = 0;
+        bench(mode.name, [&](long long n) {
+            for (long long i = 0; i < n; ++i, ++frame) {
+                int offset = static_cast<int>(frame * 4 % (2 * span));
+                SDL_Rect camera = {-400 + (offset < span ? offset : 2 * span - offset), -300, 800, 600};
+                map.render(renderer, camera);
+            }
+            sink += map.getRenderStats().drawCalls;
+        });
+    }
+
+    map.freeChunkTextures();
+    Tile::freeTilesetTexture();
+    SDL_DestroyRenderer(renderer);
+    SDL_FreeSurface(target);
+}
+
+int main(int argc, char* argv[]) {
+    for (int i = 1; i < argc; ++i) {
+        if (!strcmp(argv[i], "--filter") && i + 1 < argc) filter = argv[++i];
+        else if (!strcmp(argv[i], "--samples") && i + 1 < argc) sampleCount = std::max(1, atoi(argv[++i]));
+        else {
+            fprintf(stderr, "usage: %s [--filter TEXT] [--samples N]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    SDL_SetMainReady();
+    if (SDL_Init(0) != 0 || !(IMG_Init(IMG_INIT_PNG) & IMG_INIT_PNG)) {
+        fprintf(stderr, "SDL could not start: %s\n", SDL_GetError());
+        return 2;
+    }
+
+    printf("seed %u, chunks of %dx%d tiles, noise backend %s, %d samples of ~%.0f ms\n", SEED,
+           static_cast<int>(Chunk::SIZE), static_cast<int>(Chunk::SIZE), NoiseBatch::getBackendName(NoiseBatch::getBackend()),
+           sampleCount, SAMPLE_MS);
+    printf("%-36s %12s %12s %12s %7s %12s\n", "benchmark (ns/op)", "min", "median", "mean", "cv", "ops/sample");
+    benchNoise();
+    benchGeneration();
+    benchLookups();
+    benchRender();
+
+    IMG_Quit();
+    SDL_Quit();
+    return 0;
+}
@@ -0,0 +1,204 @@
+// Replays an input log the game recorded (last_session.input unless it was
+// told otherwise) against this build, as fast as it will run. The world is
+// generated from the logged seed, every logged event is handled just before
+// the tick it was recorded at and every frame advances exactly one tick, so
+// the session plays out as it did, whatever the frame rate was then or now.
+// Runs headless under SDL's dummy video driver unless --window is given.
+// Chunks are always generated, never read from or written to saved regions.
+//
+// Results are written as JSON: frame times, and the final world state as the
+// tick, the player's position and velocity, and a hash of the tiles around
+// the player. Given a baseline (the JSON of a replay of the same log by
+// another build), a final state that differs at all, or a frame-time
+// percentile worse by more than the threshold, makes the exit code 1. Builds
+// with the profiler also write profile.csv, with every frame's zones.
+//
+// usage: replay LOG [--window] [--output FILE] [--baseline FILE] [--threshold FRACTION]
+#define SDL_MAIN_HANDLED
+#include "tool_support.h"
+#include "InputLog.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using json = nlohmann::json;
+
+static const int HASH_RADIUS = 2; // Chunks hashed on each side of the player's
+
+static void hashBytes(Uint64& hash, const void* data, size_t size) {
+    const Uint8* bytes = static_cast<const Uint8*>(data);
+    for (size_t i = 0; i < size; ++i) {
+        hash = (hash ^ bytes[i]) * 1099511628211ULL; // FNV-1a
+    }
+}
+
+// Tiles of the chunks around the player; any not loaded yet are generated
+// here, so the hash does not depend on how far streaming had got
+static std::string hashWorld(Game& game) {
+    Map& map = game.getMap();
+    Player& player = game.getPlayer();
+    int centerX = std::floor(static_cast<float>(player.getX()) / (Chunk::SIZE * Tile::SIZE));
+    int centerY = std::floor(static_cast<float>(player.getY()) / (Chunk::SIZE * Tile::SIZE));
+
+    Uint64 hash = 14695981039346656037ULL;
+    for (int chunkY = centerY - HASH_RADIUS; chunkY <= centerY + HASH_RADIUS; ++chunkY) {
+        for (int chunkX = centerX - HASH_RADIUS; chunkX <= centerX + HASH_RADIUS; ++chunkX) {
+            if (!map.isChunkGenerated(chunkX, chunkY)) {
+                map.generateChunk(chunkX, chunkY, game.getSeed());
+            }
+            for (int y = 0; y < Chunk::SIZE; ++y) {
+                for (int x = 0; x < Chunk::SIZE; ++x) {
+                    Uint8 tile = static_cast<Uint8>(map.getTileAt(chunkX * Chunk::SIZE + x, chunkY * Chunk::SIZE + y));
+                    hashBytes(hash, &tile, 1);
+                }
+            }
+        }
+    }
+    char text[17];
+    snprintf(text, sizeof(text), "%016llx", static_cast<unsigned long long>(hash));
+    return text;
+}
+
+static json finalState(Game& game) {
+    Player& player = game.getPlayer();
+    json state;
+    state["tick"] = game.getTick();
+    state["player_x"] = player.getX();
+    state["player_y"] = player.getY();
+    state["velocity_x"] = player.getVelocityX();
+    state["velocity_y"] = player.getVelocityY();
+    state["world_hash"] = hashWorld(game);
+    return state;
+}
+
+static json replay(Game& game, const InputLog::Session& session, bool window) {
+    std::vector<double> frameMs;
+    frameMs.reserve(session.endTick);
+    Uint64 frequency = SDL_GetPerformanceFrequency();
+    Uint64 start = SDL_GetPerformanceCounter();
+
+    size_t next = 0;
+    for (Uint32 tick = 0;; ++tick) {
+        Uint64 frameStart = SDL_GetPerformanceCounter();
+        for (; next < session.entries.size() && session.entries[next].tick == tick; ++next) {
+            SDL_Event event = session.entries[next].event;
+            game.handleEvent(event);
+        }
+        if (tick == session.endTick) break;
+        if (window) {
+            // Only the log drives the game; this just keeps the window responsive
+            SDL_PumpEvents();
+            SDL_FlushEvents(SDL_FIRSTEVENT, SDL_LASTEVENT);
+        }
+
+        game.step(1);
+        game.render();
+        frameMs.push_back((SDL_GetPerformanceCounter() - frameStart) * 1000.0 / frequency);
+    }
+    double seconds = static_cast<double>(SDL_GetPerformanceCounter() - start) / frequency;
+
+    json result;
+    result["seed"] = session.seed;
+    result["events"] = session.entries.size();
+    result["frames"] = frameMs.size();
+    result["seconds"] = seconds;
+    result["frame_ms_p50"] = percentile(frameMs, 0.50);
+    result["frame_ms_p95"] = percentile(frameMs, 0.95);
+    result["frame_ms_p99"] = percentile(frameMs, 0.99);
+    result["frame_ms_max"] = frameMs.empty() ? 0.0 : *std::max_element(frameMs.begin(), frameMs.end());
+    result["final_state"] = finalState(game);
+    return result;
+}
+
+// Prints the comparison; returns how many differences and regressions there were
+static int compare(const json& results, const json& baseline, double threshold) {
+    int failures = 0;
+    if ((baseline.contains("seed") && baseline["seed"] != results["seed"]) ||
+        (baseline.contains("events") && baseline["events"] != results["events"])) {
+        printf("the baseline replayed a different log\n");
+        return 1;
+    }
+
+    const json& state = results["final_state"];
+    const json& reference = baseline["final_state"];
+    for (auto& field : state.items()) {
+        bool same = reference.contains(field.key()) && reference[field.key()] == field.value();
+        printf("%-12s %-24s %12s -> %12s%s\n", "state", field.key().c_str(),
+               reference.contains(field.key()) ? reference[field.key()].dump().c_str() : "-",
+               field.value().dump().c_str(), same ? "" : "  DIFFERS");
+        if (!same) ++failures;
+    }
+
+    const char* const frameMetrics[] = {"frame_ms_p50", "frame_ms_p95", "frame_ms_p99"};
+    for (const char* name : frameMetrics) {
+        if (!baseline.contains(name)) continue;
+        if (compareMetric("frames", name, baseline[name].get<double>(), results[name].get<double>(), true, threshold)) {
+            ++failures;
+        }
+    }
+    return failures;
+}
+
+int main(int argc, char* argv[]) {
+    const char* logPath = nullptr;
+    bool window = false;
+    const char* outputPath = "replay.json";
+    const char* baselinePath = nullptr;
+    double threshold = 0.10;
+    for (int i = 1; i < argc; ++i) {
+        bool hasValue = i + 1 < argc;
+        if (!strcmp(argv[i], "--window")) window = true;
+        else if (!strcmp(argv[i], "--output") && hasValue) outputPath = argv[++i];
+        else if (!strcmp(argv[i], "--baseline") && hasValue) baselinePath = argv[++i];
+        else if (!strcmp(argv[i], "--threshold") && hasValue) threshold = atof(argv[++i]);
+        else if (argv[i][0] != '-' && !logPath) logPath = argv[i];
+        else {
+            logPath = nullptr;
+            break;
+        }
+    }
+    if (!logPath) {
+        fprintf(stderr, "usage: %s LOG [--window] [--output FILE] [--baseline FILE] [--threshold FRACTION]\n", argv[0]);
+        return 2;
+    }
+
+    InputLog::Session session;
+    if (!InputLog::load(logPath, session)) {
+        return 2;
+    }
+    if (session.tickRate != static_cast<Uint32>(Game::TICK_RATE)) {
+        fprintf(stderr, "%s was recorded at %u ticks per second, this build runs %d; the replay will drift\n", logPath,
+                session.tickRate, static_cast<int>(Game::TICK_RATE));
+    }
+
+    Game game;
+    if (!startGame(game, "replay", window)) {
+        return 2;
+    }
+    game.setSeed(session.seed);
+
+    json results = replay(game, session, window);
+    const json& state = results["final_state"];
+    printf("%u ticks, %zu events in %.2f s  p50 %.2f ms  p99 %.2f ms  final tick %u at (%d, %d) world %s\n",
+           session.endTick, session.entries.size(), results["seconds"].get<double>(),
+           results["frame_ms_p50"].get<double>(), results["frame_ms_p99"].get<double>(), state["tick"].get<Uint32>(),
+           state["player_x"].get<int>(), state["player_y"].get<int>(), state["world_hash"].get<std::string>().c_str());
+    game.clean();
+
+    if (!writeResults(outputPath, results)) {
+        return 2;
+    }
+
+    if (!baselinePath) return 0;
+    json baseline;
+    if (!readBaseline(baselinePath, "final_state", baseline)) {
+        return 2;
+    }
+    int failures = compare(results, baseline, threshold);
+    printf("%d difference%s against %s\n", failures, failures == 1 ? "" : "s", baselinePath);
+    return failures > 0 ? 1 : 0;
+}
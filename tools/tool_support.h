@@ -0,0 +1,77 @@
+#ifndef TOOL_SUPPORT_H
+#define TOOL_SUPPORT_H
+
+// Pieces game_bench and replay share: running the real Game without a
+// display, frame-time percentiles, and JSON results compared against a
+// baseline run.
+#include "Game.h"
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <vector>
+
+// Starts `game` straight into gameplay, with no frame rate limit and chunks
+// only ever generated. Unless `window`, it runs under SDL's dummy video
+// driver and the software renderer; an SDL_VIDEODRIVER already in the
+// environment wins. False, with the reason on stderr, if SDL could not start
+inline bool startGame(Game& game, const char* title, bool window) {
+    SDL_SetMainReady();
+    if (!window) {
+        SDL_setenv("SDL_VIDEODRIVER", "dummy", 0);
+        SDL_SetHint(SDL_HINT_RENDER_DRIVER, "software");
+    }
+
+    game.init(title, SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, 800, 600, false);
+    if (!game.running()) {
+        fprintf(stderr, "SDL could not start\n");
+        return false;
+    }
+    game.setFrameRateLimit(0);
+    game.setGameState(GameState::GAMEPLAY);
+    game.getMap().setPersistence(false);
+    return true;
+}
+
+inline double percentile(std::vector<double> values, double fraction) {
+    if (values.empty()) return 0.0;
+    size_t rank = std::min(values.size() - 1, static_cast<size_t>(fraction * values.size()));
+    std::nth_element(values.begin(), values.begin() + rank, values.end());
+    return values[rank];
+}
+
+inline bool writeResults(const char* path, const nlohmann::json& results) {
+    std::ofstream output(path);
+    output << results.dump(2) << "\n";
+    if (!output) {
+        fprintf(stderr, "Could not write %s\n", path);
+        return false;
+    }
+    return true;
+}
+
+// False, with the reason on stderr, unless `path` holds JSON with `requiredKey`
+inline bool readBaseline(const char* path, const char* requiredKey, nlohmann::json& baseline) {
+    std::ifstream file(path);
+    baseline = nlohmann::json::parse(file, nullptr, false);
+    if (baseline.is_discarded() || !baseline.contains(requiredKey)) {
+        fprintf(stderr, "Could not read baseline %s\n", path);
+        return false;
+    }
+    return true;
+}
+
+// Prints a metric next to its baseline value; true if it got worse by more
+// than `threshold`, a fraction of the baseline. From zero any increase
+// counts, however small
+inline bool compareMetric(const char* group, const char* name, double reference, double value, bool higherIsWorse,
+                          double threshold) {
+    double change = reference != 0.0 ? (value - reference) / reference : value > 0.0 ? HUGE_VAL : 0.0;
+    bool worse = higherIsWorse ? change > threshold : -change > threshold;
+    printf("%-12s %-24s %12.3f -> %12.3f (%+6.1f%%)%s\n", group, name, reference, value, 100.0 * change,
+           worse ? "  REGRESSION" : "");
+    return worse;
+}
+
+#endif